@@ -41,6 +41,12 @@ namespace gazprea {
 
 		bool isExpressionToReplaceIdentityNull = false;
 
+		//ConstFoldWalk
+		std::string literalText;  // source text of literals created by folding, which have no parse tree node
+
+		//EscapeWalk
+		bool isStackTemporary = false;  // the value's Variable lives in the stack frame until its consumer frees it
+
 		//Methods	
 		virtual ~AST();	
     	static std::shared_ptr<AST> NewNilNode(); /** create a node with NIL_TYPE and no parse tree node */
@@ -0,0 +1,55 @@
+#pragma once
+#include "GazpreaParser.h"
+#include "AST.h"
+#include "SymbolTable.h"
+#include "Symbol.h"
+#include "VariableSymbol.h"
+#include "SubroutineSymbol.h"
+
+#include <map>
+
+namespace gazprea {
+
+// Replaces scalar expressions whose operands are all literals with a single literal node, and reads of const
+// variables initialized with a literal with a copy of that literal. Runs after TypeWalk; folding follows the
+// runtime's 32-bit integer and float semantics and leaves anything that would raise a runtime error unfolded
+class ConstFoldWalk {
+    private:
+        std::shared_ptr<SymbolTable> symtab;
+        std::map<std::shared_ptr<Symbol>, std::shared_ptr<AST>> constantValues;  // const variable -> literal
+        int numExprAncestors = 0;
+
+        struct ConstantValue {
+            int typeId;
+            int32_t integerValue = 0;
+            float realValue = 0;
+            bool booleanValue = false;
+        };
+
+    public:
+        int numExpressionsFolded = 0;
+
+        ConstFoldWalk(std::shared_ptr<SymbolTable> symtab);
+        ~ConstFoldWalk();
+
+        void visit(std::shared_ptr<AST> t);
+        void visitChildren(std::shared_ptr<AST> t);
+        void visitVariableDeclaration(std::shared_ptr<AST> t);
+        void visitCallArguments(std::shared_ptr<AST> t);
+
+        // Folding; each returns the literal that replaces t, or nullptr when t has to stay as it is
+        std::shared_ptr<AST> fold(std::shared_ptr<AST> t);
+        std::shared_ptr<AST> foldBinaryOperation(std::shared_ptr<AST> t);
+        std::shared_ptr<AST> foldUnaryOperation(std::shared_ptr<AST> t);
+        std::shared_ptr<AST> foldCast(std::shared_ptr<AST> t);
+        std::shared_ptr<AST> foldLength(std::shared_ptr<AST> t);
+        std::shared_ptr<AST> foldIdentifier(std::shared_ptr<AST> t);
+
+        // Helper Methods
+        bool getConstantValue(std::shared_ptr<AST> t, ConstantValue &value);
+        std::shared_ptr<AST> makeLiteral(ConstantValue &value, std::shared_ptr<AST> replaced);
+        bool isAtomicExpression(std::shared_ptr<AST> t);
+        int32_t integerExponentiation(int32_t base, int32_t exponent);
+};
+
+} // namespace gazprea
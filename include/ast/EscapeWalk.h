@@ -0,0 +1,25 @@
+#pragma once
+#include "GazpreaParser.h"
+#include "AST.h"
+
+namespace gazprea {
+
+// Marks expression temporaries that never escape the operation consuming them: they are only read by it and
+// freed right after, never stored, returned, moved into a variable or aliased by an index reference or a var
+// parameter. LLVMGen keeps the Variable of a marked temporary in the stack frame instead of the heap.
+// Runs last, once no walk rewrites the AST anymore
+class EscapeWalk {
+    public:
+        EscapeWalk();
+        ~EscapeWalk();
+
+        void visit(std::shared_ptr<AST> t);
+        void visitChildren(std::shared_ptr<AST> t);
+
+        // Helper Methods
+        void markOperand(std::shared_ptr<AST> t);
+        void markExpression(std::shared_ptr<AST> t);
+        bool isStackTemporaryProducer(std::shared_ptr<AST> t);
+};
+
+} // namespace gazprea
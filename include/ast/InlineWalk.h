@@ -0,0 +1,51 @@
+#pragma once
+#include "GazpreaParser.h"
+#include "AST.h"
+#include "SymbolTable.h"
+#include "Symbol.h"
+#include "VariableSymbol.h"
+#include "SubroutineSymbol.h"
+
+#include <map>
+#include <vector>
+
+namespace gazprea {
+
+// Substitutes calls to small, non-recursive functions whose body is a single expression with a copy of that
+// expression. Runs after TypeWalk, so every node it copies or creates already carries its evalType
+class InlineWalk {
+    private:
+        std::shared_ptr<SymbolTable> symtab;
+        std::vector<std::shared_ptr<SubroutineSymbol>> expandingSubroutines;  // callees whose body is being walked
+
+        const static int MAX_INLINE_DEPTH = 4;
+        const static int MAX_INLINE_BODY_SIZE = 24;  // number of AST nodes in the return expression
+
+    public:
+        int numCallsInlined = 0;
+
+        InlineWalk(std::shared_ptr<SymbolTable> symtab);
+        ~InlineWalk();
+
+        void visit(std::shared_ptr<AST> t);
+        void visitChildren(std::shared_ptr<AST> t);
+
+        // Inlining
+        std::shared_ptr<AST> inlineCall(std::shared_ptr<AST> t);
+        std::shared_ptr<AST> getSubroutineDefinition(std::shared_ptr<SubroutineSymbol> subroutineSymbol);
+        std::shared_ptr<AST> getReturnExpression(std::shared_ptr<AST> definition);
+
+        // Helper Methods
+        bool isInlinableScalarType(std::shared_ptr<Type> type);
+        bool isInlinableExpression(std::shared_ptr<AST> t, int &numNodes);
+        bool isAtomicExpression(std::shared_ptr<AST> t);
+        void countParameterUses(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, size_t> &parameterIndex,
+                                std::vector<int> &numUses);
+        bool usesParameter(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, size_t> &parameterIndex, size_t index);
+        bool isEvaluatedFirst(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, size_t> &parameterIndex,
+                              size_t index);
+        std::shared_ptr<AST> substitute(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, std::shared_ptr<AST>> &arguments);
+        std::shared_ptr<AST> cloneTree(std::shared_ptr<AST> t);
+};
+
+} // namespace gazprea
@@ -6,14 +6,27 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
-#include "llvm/IR/NoFolder.h"
 #include "llvm/IR/Verifier.h" 
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Program.h"
 
 #include "llvm/Support/raw_os_ostream.h"
 
 #include "SubroutineSymbol.h"
 #include "VariableSymbol.h"
 #include "LLVMIRBranch.h"
+#include "LLVMIRBuilder.h"
 #include "LLVMIRFunction.h"
 
 #include "MatrixType.h"
@@ -27,16 +40,44 @@ class LLVMGen {
     public:
         std::shared_ptr<SymbolTable> symtab;
         llvm::LLVMContext globalCtx;
-        llvm::IRBuilder<llvm::NoFolder> ir;
+        unsigned optLevel;  // 0 to 3, same as -O<n>
+        LLVMIRBuilder ir;
         llvm::Module mod;
         std::string outfile;
+        std::unique_ptr<llvm::TargetMachine> targetMachine;  // host target, null if it is not available
+        enum class EmitKind { LL, BC, OBJ };
+        EmitKind emitKind = EmitKind::LL;  // format of the output file, ignored when linking an executable
+        std::string runtimeLibrary;  // if set, link the object file with this static gazrt into an executable
 
         llvm::StructType *runtimeTypeTy;
+        llvm::StructType *runtimeArrayTypeTy;
         llvm::StructType *runtimeVariableTy;
         llvm::StructType *runtimeStackTy;
         llvm::StructType *runtimeStackItemTy;
         
         llvm::Value* globalStack; //initialized in initializeGlobalVariables 
+        llvm::Value* internedTypes; //initialized in initializeGlobalVariables
+
+        // mirrors InternedTypeID in runtime/src/Enums.h
+        enum {
+            INTERNED_TYPE_BOOLEAN_SCALAR,
+            INTERNED_TYPE_CHARACTER_SCALAR,
+            INTERNED_TYPE_INTEGER_SCALAR,
+            INTERNED_TYPE_REAL_SCALAR,
+            INTERNED_TYPE_INTEGER_INTERVAL,
+            INTERNED_TYPE_UNKNOWN,
+            NUM_INTERNED_TYPES
+        };
+
+        // mirrors the basic types of ElementTypeID in runtime/src/Enums.h
+        enum {
+            ELEMENT_INTEGER,
+            ELEMENT_REAL,
+            ELEMENT_BOOLEAN,
+            ELEMENT_CHARACTER
+        };
+
+        const static int MAX_FUSED_STACK_DEPTH = 8;  // mirrors KERNEL_FUSED_MAX_DEPTH in runtime/src/ArrayKernels.h
 
         llvm::Function* currentSubroutine;
 
@@ -51,9 +92,9 @@ class LLVMGen {
         llvm::Value *llvmSubroutineReturnType = nullptr;
 
         bool isExpressionToReplaceIdentityNull = false;
+        bool isIndexingWriteTarget = false;  // set while visiting expressions that are assigned to or passed as var
 
-        LLVMGen(std::shared_ptr<SymbolTable> symtab, std::shared_ptr<TypePromote> tp, std::string& outfile);
-        ~LLVMGen();
+        LLVMGen(std::shared_ptr<SymbolTable> symtab, std::shared_ptr<TypePromote> tp, std::string& outfile, unsigned optLevel = 0);
 
         //AST Walker
         void visit(std::shared_ptr<AST> t);
@@ -82,6 +123,7 @@ class LLVMGen {
         void visitFilter(std::shared_ptr<AST> t);
         void visitTupleLiteral(std::shared_ptr<AST> t);
         void visitVectorMatrixLiteral(std::shared_ptr<AST> t);
+        bool visitConstantVectorLiteral(std::shared_ptr<AST> t);
 
         // Other Sub-Expression rules
         void visitExpression(std::shared_ptr<AST> t);
@@ -100,8 +142,33 @@ class LLVMGen {
         void visitInterval(std::shared_ptr<AST> t);
         void visitConcatenation(std::shared_ptr<AST> t);
 
+        // Fused Array Expressions
+        int getBinaryOpCode(std::shared_ptr<AST> t);
+        int getArithmeticElementTypeId(std::shared_ptr<Type> type);
+        bool isFusableArrayOperation(std::shared_ptr<AST> t, int elementTypeId);
+        bool isFusableOperand(std::shared_ptr<AST> t);
+        bool canFuseArrayExpression(std::shared_ptr<AST> t);
+        void collectFusedProgram(std::shared_ptr<AST> t, int elementTypeId, std::vector<int32_t> &program,
+                                 std::vector<std::shared_ptr<AST>> &operands, int &stackDepth, int &maxStackDepth);
+        void visitFusedArrayExpression(std::shared_ptr<AST> t);
+
+        // Unboxed Scalar Operations
+        std::string getBinaryOperationEntryPoint(std::shared_ptr<AST> t);
+        int getUnboxedScalarTypeId(std::shared_ptr<AST> t);
+        bool canUnboxOperation(std::shared_ptr<AST> t);
+        llvm::Value* visitUnboxedScalar(std::shared_ptr<AST> t);
+        llvm::Value* visitUnboxedBinaryOperation(std::shared_ptr<AST> t);
+        llvm::Value* visitUnboxedUnaryOperation(std::shared_ptr<AST> t);
+        llvm::Value* unboxScalar(llvm::Value* runtimeVariableObject, int typeId);
+        llvm::Value* boxScalar(llvm::Value* scalarValue, std::shared_ptr<AST> t = nullptr);  // t is the operation boxed, if any
+        llvm::Value* createConditionValue(std::shared_ptr<AST> t);
+        bool canInlineIndexing(std::shared_ptr<AST> t);
+        llvm::Value* visitInlinedIndexing(std::shared_ptr<AST> t);
+        void createDivisionByZeroCheck(llvm::Value* divisor, const std::string& errorMsg);
+
         // Call
         void visitCallSubroutineInExpression(std::shared_ptr<AST> t);
+        void visitCallArguments(std::shared_ptr<AST> t);
 
         // Other Statements
         void visitVarDeclarationStatement(std::shared_ptr<AST> t);
@@ -117,7 +184,12 @@ class LLVMGen {
         void visitTupleAccess(std::shared_ptr<AST> t);
 
         //Helper Methods 
-        void Print();
+        bool Print();
+        void optimize();
+        void initializeTargetMachine();
+        bool emitObjectFile(const std::string& filename);
+        bool linkExecutable(const std::string& objectFile);
+        int runMain(const std::string& sharedRuntimeLibrary);
         void initializeGlobalVariables();
         void freeGlobalVariables();
         void freeAllVariablesDeclaredInBlockScope(std::shared_ptr<LocalScope> scope);
@@ -125,8 +197,21 @@ class LLVMGen {
         void freeSubroutineParameters(std::shared_ptr<SubroutineSymbol> subroutineSymbol);
         void freeExpressionIfNecessary(std::shared_ptr<AST> t);
         void freeExprAtomIfNecessary(std::shared_ptr<AST> t);
+        llvm::Value* allocateTemporary(std::shared_ptr<AST> t);
+        void freeTemporary(std::shared_ptr<AST> t);
+        bool isTemporaryExpression(std::shared_ptr<AST> t);
+        llvm::Value* takeExpressionValue(std::shared_ptr<AST> t);
+        void initializeDeclaredVariable(llvm::Value *runtimeVariableObject, llvm::Value *runtimeTypeObject, std::shared_ptr<AST> t);
         llvm::Value* getStack();
+        llvm::Value* getInternedRuntimeType(int internedTypeId);
+        int getInternedTypeId(int typeId);
+        bool isStackAllocatableType(std::shared_ptr<Type> type);
+        llvm::Value* createEntryBlockVariableAlloca(const std::string& name);
         std::string unescapeString(const std::string &s);
+        char getCharacterAtomValue(std::shared_ptr<AST> t);
+        bool getConstantLiteralElements(std::shared_ptr<AST> t, size_t &nodeType, std::vector<llvm::Constant*> &elements);
+        llvm::Value* createConstantArrayVariable(llvm::Constant *values, bool isString, int elementTypeId, int nDim,
+                                                 int64_t dim1, int64_t dim2);
 
         //Iterator loop Generator & Filter Helper Methods
         llvm::Value* createBranchCondition(llvm::Value* currentIndex, llvm::Value* domainLength);
@@ -4,7 +4,6 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Function.h"
-#include "llvm/IR/NoFolder.h"
 
 #include <vector>
 
@@ -21,7 +20,7 @@ public:
 
     LLVMIRBranch(
         llvm::LLVMContext *context, 
-        llvm::IRBuilder<llvm::NoFolder> *builder, 
+        llvm::IRBuilderBase *builder, 
         llvm::Module *module
     ): m_context(context), m_builder(builder), m_module(module) {};
 
@@ -43,7 +42,7 @@ public:
 private:
     // access to the context and module
     llvm::LLVMContext *m_context;
-    llvm::IRBuilder<llvm::NoFolder> *m_builder;
+    llvm::IRBuilderBase *m_builder;
     llvm::Module *m_module;
 
 };
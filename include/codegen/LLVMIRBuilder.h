@@ -0,0 +1,28 @@
+#pragma once
+
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/ConstantFolder.h"
+#include "llvm/IR/NoFolder.h"
+
+/**
+ * IRBuilder whose constant folding is chosen when it is constructed
+ * Folding is off by default so the emitted IR follows the AST one to one; it is turned on when gazc optimizes
+ */
+class LLVMIRBuilder : public llvm::IRBuilderBase {
+public:
+    LLVMIRBuilder(llvm::LLVMContext &context, bool foldConstants)
+        : llvm::IRBuilderBase(
+            context,
+            foldConstants ? static_cast<const llvm::IRBuilderFolder &>(m_constantFolder) : m_noFolder,
+            m_inserter,
+            nullptr,
+            llvm::None
+        ) {}
+
+private:
+    // only referenced by the base class, so they can be constructed after it like in llvm::IRBuilder
+    llvm::ConstantFolder m_constantFolder;
+    llvm::NoFolder m_noFolder;
+    llvm::IRBuilderDefaultInserter m_inserter;
+};
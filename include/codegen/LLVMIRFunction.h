@@ -3,7 +3,6 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Function.h"
-#include "llvm/IR/NoFolder.h"
 #include <map>
 #include "GazpreaParser.h"
 
@@ -15,7 +14,7 @@ class LLVMIRFunction {
 public:
     LLVMIRFunction(
         llvm::LLVMContext *context, 
-        llvm::IRBuilder<llvm::NoFolder> *builder, 
+        llvm::IRBuilderBase *builder, 
         llvm::Module *module
     ): m_context(context), m_builder(builder), m_module(module) {};
 
@@ -33,7 +32,7 @@ public:
 private:
     // access to the context and module
     llvm::LLVMContext *m_context;
-    llvm::IRBuilder<llvm::NoFolder> *m_builder;
+    llvm::IRBuilderBase *m_builder;
     llvm::Module *m_module;
 
     std::map<std::string, llvm::Function *> m_nameToFunction;  // used for function calls
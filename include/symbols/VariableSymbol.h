@@ -11,6 +11,7 @@ namespace gazprea {
     public:
         std::string typeQualifier;  // Can be "var" or "const"
         bool isGlobalVariable = false;
+        bool isStackAllocated = false;  // The runtime Variable object lives in an alloca rather than on the heap
         VariableSymbol(std::string name, std::shared_ptr<Type> type);
         bool isType() {
             return false;
@@ -0,0 +1,647 @@
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "ArrayKernels.h"
+#include "NDArray.h"
+#include "RuntimeErrors.h"
+#include "ThreadPool.h"
+
+// expands the loop once per stride pattern so that the unit-stride and broadcast cases index with i alone and can be
+// vectorized; inside the body v1 and v2 are the current operands and i is the result index
+#define KERNEL_ELEMENTWISE_LOOP(T, op1, op1Stride, op2, op2Stride, size, ...)   \
+    if (op1Stride == 1 && op2Stride == 1) {                                     \
+        for (int64_t i = 0; i < size; i++) {                                    \
+            T v1 = op1[i]; T v2 = op2[i]; __VA_ARGS__;                          \
+        }                                                                       \
+    } else if (op1Stride == 0 && op2Stride == 1) {                              \
+        T v1 = op1[0];                                                          \
+        for (int64_t i = 0; i < size; i++) {                                    \
+            T v2 = op2[i]; __VA_ARGS__;                                         \
+        }                                                                       \
+    } else if (op1Stride == 1 && op2Stride == 0) {                              \
+        T v2 = op2[0];                                                          \
+        for (int64_t i = 0; i < size; i++) {                                    \
+            T v1 = op1[i]; __VA_ARGS__;                                         \
+        }                                                                       \
+    } else {                                                                    \
+        for (int64_t i = 0; i < size; i++) {                                    \
+            T v1 = op1[i * op1Stride]; T v2 = op2[i * op2Stride]; __VA_ARGS__;  \
+        }                                                                       \
+    }
+
+// computes size items of an element-wise loop; strides count elements and op2 is NULL for unary ops
+typedef void (*KernelRange)(int32_t opcode, const void *op1, int64_t op1Stride, const void *op2, int64_t op2Stride,
+                            int64_t size, void *result);
+
+typedef struct struct_kernel_elementwise_loop {
+    KernelRange m_range;
+    int32_t m_opcode;
+    const char *m_op1;
+    int64_t m_op1Stride;
+    const char *m_op2;
+    int64_t m_op2Stride;
+    char *m_result;
+    int64_t m_operandSize;
+    int64_t m_resultSize;
+} KernelElementwiseLoop;
+
+static void kernelElementwiseChunk(void *context, int64_t begin, int64_t end) {
+    KernelElementwiseLoop *loop = context;
+    const char *op2 = loop->m_op2 == NULL ? NULL : loop->m_op2 + begin * loop->m_op2Stride * loop->m_operandSize;
+    loop->m_range(loop->m_opcode, loop->m_op1 + begin * loop->m_op1Stride * loop->m_operandSize, loop->m_op1Stride,
+                  op2, loop->m_op2Stride, end - begin, loop->m_result + begin * loop->m_resultSize);
+}
+
+static void kernelRunElementwise(KernelRange range, int32_t opcode, const void *op1, int64_t op1Stride, const void *op2,
+                                 int64_t op2Stride, int64_t size, void *result, int64_t operandSize, int64_t resultSize) {
+    KernelElementwiseLoop loop = {range, opcode, op1, op1Stride, op2, op2Stride, result, operandSize, resultSize};
+    threadPoolParallelFor(size, 1, kernelElementwiseChunk, &loop);
+}
+
+static bool kernelBinOpIsComparison(BinOpCode opcode) {
+    return opcode == BINARY_LT || opcode == BINARY_BT || opcode == BINARY_LEQ || opcode == BINARY_BEQ;
+}
+
+// checked before the loop is split up, so the division loops stay branch free and no worker thread has to exit
+static bool kernelIntegerHasZero(const int32_t *op, int64_t stride, int64_t size) {
+    if (stride == 0)
+        return size > 0 && op[0] == 0;
+    bool hasZero = false;
+    for (int64_t i = 0; i < size; i++)
+        hasZero |= op[i * stride] == 0;
+    return hasZero;
+}
+
+// integerExponentiation raises the same error for these, but it may be running on a worker thread
+static bool kernelIntegerHasZeroToNegativePower(const int32_t *base, int64_t baseStride, const int32_t *exponent,
+                                                int64_t exponentStride, int64_t size) {
+    bool hasZeroToNegativePower = false;
+    for (int64_t i = 0; i < size; i++)
+        hasZeroToNegativePower |= base[i * baseStride] == 0 && exponent[i * exponentStride] < 0;
+    return hasZeroToNegativePower;
+}
+
+KERNEL_TARGET_CLONES
+static void kernelIntegerBinOpRange(int32_t opcode, const void *op1Data, int64_t op1Stride, const void *op2Data,
+                                    int64_t op2Stride, int64_t size, void *restrict result) {
+    const int32_t *restrict op1 = op1Data;
+    const int32_t *restrict op2 = op2Data;
+    bool *restrict boolResult = result;
+    int32_t *restrict intResult = result;
+    switch (opcode) {
+        case BINARY_LT:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 < v2) break;
+        case BINARY_BT:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 > v2) break;
+        case BINARY_LEQ:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 <= v2) break;
+        case BINARY_BEQ:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 >= v2) break;
+        case BINARY_EXPONENT:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, intResult[i] = integerExponentiation(v1, v2)) break;
+        case BINARY_MULTIPLY:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, intResult[i] = v1 * v2) break;
+        case BINARY_DIVIDE:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, intResult[i] = v1 / v2) break;
+        case BINARY_REMAINDER:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, intResult[i] = (int) ((long) v1 % (long) v2)) break;
+        case BINARY_PLUS:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, intResult[i] = v1 + v2) break;
+        case BINARY_MINUS:
+            KERNEL_ELEMENTWISE_LOOP(int32_t, op1, op1Stride, op2, op2Stride, size, intResult[i] = v1 - v2) break;
+        default:
+            errorAndExit("This should not happen!"); break;
+    }
+}
+
+KERNEL_TARGET_CLONES
+static void kernelRealBinOpRange(int32_t opcode, const void *op1Data, int64_t op1Stride, const void *op2Data,
+                                 int64_t op2Stride, int64_t size, void *restrict result) {
+    const float *restrict op1 = op1Data;
+    const float *restrict op2 = op2Data;
+    bool *restrict boolResult = result;
+    float *restrict realResult = result;
+    switch (opcode) {
+        case BINARY_LT:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 < v2) break;
+        case BINARY_BT:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 > v2) break;
+        case BINARY_LEQ:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 <= v2) break;
+        case BINARY_BEQ:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, boolResult[i] = v1 >= v2) break;
+        case BINARY_EXPONENT:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, realResult[i] = powf(v1, v2)) break;
+        case BINARY_MULTIPLY:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, realResult[i] = v1 * v2) break;
+        case BINARY_DIVIDE:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, realResult[i] = v1 / v2) break;
+        case BINARY_REMAINDER:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, realResult[i] = fmodf(v1, v2)) break;
+        case BINARY_PLUS:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, realResult[i] = v1 + v2) break;
+        case BINARY_MINUS:
+            KERNEL_ELEMENTWISE_LOOP(float, op1, op1Stride, op2, op2Stride, size, realResult[i] = v1 - v2) break;
+        default:
+            errorAndExit("This should not happen!"); break;
+    }
+}
+
+// operands are normalized with != 0 so the result is 0 or 1 like the scalar && and || it replaces
+KERNEL_TARGET_CLONES
+static void kernelBooleanBinOpRange(int32_t opcode, const void *op1Data, int64_t op1Stride, const void *op2Data,
+                                    int64_t op2Stride, int64_t size, void *resultData) {
+    const bool *restrict op1 = op1Data;
+    const bool *restrict op2 = op2Data;
+    bool *restrict result = resultData;
+    switch (opcode) {
+        case BINARY_EQ:
+            KERNEL_ELEMENTWISE_LOOP(bool, op1, op1Stride, op2, op2Stride, size, result[i] = (v1 != 0) == (v2 != 0)) break;
+        case BINARY_NE:
+            KERNEL_ELEMENTWISE_LOOP(bool, op1, op1Stride, op2, op2Stride, size, result[i] = (v1 != 0) != (v2 != 0)) break;
+        case BINARY_AND:
+            KERNEL_ELEMENTWISE_LOOP(bool, op1, op1Stride, op2, op2Stride, size, result[i] = (v1 != 0) & (v2 != 0)) break;
+        case BINARY_OR:
+            KERNEL_ELEMENTWISE_LOOP(bool, op1, op1Stride, op2, op2Stride, size, result[i] = (v1 != 0) | (v2 != 0)) break;
+        case BINARY_XOR:
+            KERNEL_ELEMENTWISE_LOOP(bool, op1, op1Stride, op2, op2Stride, size, result[i] = (v1 != 0) ^ (v2 != 0)) break;
+        default:
+            errorAndExit("This should not happen!"); break;
+    }
+}
+
+KERNEL_TARGET_CLONES
+static void kernelIntegerUnaryOpRange(int32_t opcode, const void *srcData, int64_t srcStride, const void *unused,
+                                      int64_t unusedStride, int64_t size, void *resultData) {
+    const int32_t *restrict src = srcData;
+    int32_t *restrict result = resultData;
+    if (opcode == UNARY_MINUS) {
+        for (int64_t i = 0; i < size; i++)
+            result[i] = -src[i];
+    } else {
+        for (int64_t i = 0; i < size; i++)
+            result[i] = src[i];
+    }
+}
+
+KERNEL_TARGET_CLONES
+static void kernelRealUnaryOpRange(int32_t opcode, const void *srcData, int64_t srcStride, const void *unused,
+                                   int64_t unusedStride, int64_t size, void *resultData) {
+    const float *restrict src = srcData;
+    float *restrict result = resultData;
+    if (opcode == UNARY_MINUS) {
+        for (int64_t i = 0; i < size; i++)
+            result[i] = -src[i];
+    } else {
+        for (int64_t i = 0; i < size; i++)
+            result[i] = src[i];
+    }
+}
+
+KERNEL_TARGET_CLONES
+static void kernelBooleanUnaryOpRange(int32_t opcode, const void *srcData, int64_t srcStride, const void *unused,
+                                      int64_t unusedStride, int64_t size, void *resultData) {
+    const bool *restrict src = srcData;
+    bool *restrict result = resultData;
+    for (int64_t i = 0; i < size; i++)
+        result[i] = src[i] == 0;
+}
+
+void kernelIntegerBinOp(BinOpCode opcode, const int32_t *op1, int64_t op1Stride, const int32_t *op2, int64_t op2Stride, int64_t size, void *result) {
+    if (opcode == BINARY_DIVIDE && kernelIntegerHasZero(op2, op2Stride, size)) {
+        errorAndExit("Attempt to divide by zero!");
+    }
+    if (opcode == BINARY_REMAINDER && kernelIntegerHasZero(op2, op2Stride, size)) {
+        errorAndExit("Attempt to mod by zero!");
+    }
+    if (opcode == BINARY_EXPONENT && kernelIntegerHasZeroToNegativePower(op1, op1Stride, op2, op2Stride, size)) {
+        errorAndExit("Division by zero!");
+    }
+    kernelRunElementwise(kernelIntegerBinOpRange, opcode, op1, op1Stride, op2, op2Stride, size, result, sizeof(int32_t),
+                         kernelBinOpIsComparison(opcode) ? sizeof(bool) : sizeof(int32_t));
+}
+
+void kernelRealBinOp(BinOpCode opcode, const float *op1, int64_t op1Stride, const float *op2, int64_t op2Stride, int64_t size, void *result) {
+    kernelRunElementwise(kernelRealBinOpRange, opcode, op1, op1Stride, op2, op2Stride, size, result, sizeof(float),
+                         kernelBinOpIsComparison(opcode) ? sizeof(bool) : sizeof(float));
+}
+
+void kernelBooleanBinOp(BinOpCode opcode, const bool *op1, int64_t op1Stride, const bool *op2, int64_t op2Stride, int64_t size, bool *result) {
+    kernelRunElementwise(kernelBooleanBinOpRange, opcode, op1, op1Stride, op2, op2Stride, size, result, sizeof(bool), sizeof(bool));
+}
+
+void kernelIntegerUnaryOp(UnaryOpCode opcode, const int32_t *src, int64_t size, int32_t *result) {
+    kernelRunElementwise(kernelIntegerUnaryOpRange, opcode, src, 1, NULL, 0, size, result, sizeof(int32_t), sizeof(int32_t));
+}
+
+void kernelRealUnaryOp(UnaryOpCode opcode, const float *src, int64_t size, float *result) {
+    kernelRunElementwise(kernelRealUnaryOpRange, opcode, src, 1, NULL, 0, size, result, sizeof(float), sizeof(float));
+}
+
+void kernelBooleanUnaryOp(UnaryOpCode opcode, const bool *src, int64_t size, bool *result) {
+    kernelRunElementwise(kernelBooleanUnaryOpRange, opcode, src, 1, NULL, 0, size, result, sizeof(bool), sizeof(bool));
+}
+
+KERNEL_TARGET_CLONES
+static uint32_t kernelIntegerDotProductBlock(const int32_t *restrict op1, const int32_t *restrict op2, int64_t size) {
+    // unsigned so the wrap around is defined and the compiler is free to split the sum across vector lanes
+    uint32_t sum = 0;
+    for (int64_t i = 0; i < size; i++)
+        sum += (uint32_t)op1[i] * (uint32_t)op2[i];
+    return sum;
+}
+
+#if KERNEL_REAL_SUMMATION != KERNEL_SUMMATION_KAHAN
+// the lanes are spelled out instead of left to the vectorizer because float addition may not be reordered;
+// fixing them in the source keeps the result the same for every target clone
+static float kernelReduceLanes(const float *lanes) {
+    float sum = 0.0f;
+    for (int l = 0; l < KERNEL_DOT_LANES; l++)
+        sum += lanes[l];
+    return sum;
+}
+
+KERNEL_TARGET_CLONES
+static float kernelRealDotProductMultiAccumulator(const float *restrict op1, const float *restrict op2, int64_t size) {
+    float lanes[KERNEL_DOT_LANES] = {0.0f};
+    int64_t i = 0;
+    for (; i + KERNEL_DOT_LANES <= size; i += KERNEL_DOT_LANES) {
+        for (int l = 0; l < KERNEL_DOT_LANES; l++)
+            lanes[l] += op1[i + l] * op2[i + l];
+    }
+    float sum = kernelReduceLanes(lanes);
+    for (; i < size; i++)
+        sum += op1[i] * op2[i];
+    return sum;
+}
+#endif
+
+#if KERNEL_REAL_SUMMATION == KERNEL_SUMMATION_PAIRWISE
+// the split point is kept a multiple of the lane count so every block but the last runs without a tail
+static float kernelRealDotProductPairwise(const float *op1, const float *op2, int64_t size) {
+    if (size <= KERNEL_PAIRWISE_BLOCK)
+        return kernelRealDotProductMultiAccumulator(op1, op2, size);
+    int64_t half = (size / 2 + KERNEL_DOT_LANES - 1) / KERNEL_DOT_LANES * KERNEL_DOT_LANES;
+    return kernelRealDotProductPairwise(op1, op2, half) + kernelRealDotProductPairwise(op1 + half, op2 + half, size - half);
+}
+
+#elif KERNEL_REAL_SUMMATION == KERNEL_SUMMATION_KAHAN
+// ArrayKernels.c is compiled with -ffp-contract=off, otherwise the compensation below could be fused away
+KERNEL_TARGET_CLONES
+static float kernelRealDotProductKahan(const float *restrict op1, const float *restrict op2, int64_t size) {
+    float lanes[KERNEL_DOT_LANES] = {0.0f};
+    float compensations[KERNEL_DOT_LANES] = {0.0f};
+    int64_t i = 0;
+    for (; i + KERNEL_DOT_LANES <= size; i += KERNEL_DOT_LANES) {
+        for (int l = 0; l < KERNEL_DOT_LANES; l++) {
+            float term = op1[i + l] * op2[i + l] - compensations[l];
+            float sum = lanes[l] + term;
+            compensations[l] = (sum - lanes[l]) - term;
+            lanes[l] = sum;
+        }
+    }
+    float sum = 0.0f;
+    float compensation = 0.0f;
+    for (int l = 0; l < KERNEL_DOT_LANES; l++) {
+        float term = lanes[l] - compensations[l] - compensation;
+        float newSum = sum + term;
+        compensation = (newSum - sum) - term;
+        sum = newSum;
+    }
+    for (; i < size; i++) {
+        float term = op1[i] * op2[i] - compensation;
+        float newSum = sum + term;
+        compensation = (newSum - sum) - term;
+        sum = newSum;
+    }
+    return sum;
+}
+#endif
+
+static float kernelRealDotProductBlock(const float *op1, const float *op2, int64_t size) {
+#if KERNEL_REAL_SUMMATION == KERNEL_SUMMATION_KAHAN
+    return kernelRealDotProductKahan(op1, op2, size);
+#elif KERNEL_REAL_SUMMATION == KERNEL_SUMMATION_PAIRWISE
+    return kernelRealDotProductPairwise(op1, op2, size);
+#else
+    return kernelRealDotProductMultiAccumulator(op1, op2, size);
+#endif
+}
+
+// adds up the block sums in the same summation order as the blocks themselves
+static float kernelRealSumPartials(const float *partials, int64_t size) {
+#if KERNEL_REAL_SUMMATION == KERNEL_SUMMATION_KAHAN
+    float sum = 0.0f;
+    float compensation = 0.0f;
+    for (int64_t i = 0; i < size; i++) {
+        float term = partials[i] - compensation;
+        float newSum = sum + term;
+        compensation = (newSum - sum) - term;
+        sum = newSum;
+    }
+    return sum;
+#elif KERNEL_REAL_SUMMATION == KERNEL_SUMMATION_PAIRWISE
+    if (size == 1)
+        return partials[0];
+    return kernelRealSumPartials(partials, size / 2) + kernelRealSumPartials(partials + size / 2, size - size / 2);
+#else
+    float sum = 0.0f;
+    for (int64_t i = 0; i < size; i++)
+        sum += partials[i];
+    return sum;
+#endif
+}
+
+// long vectors are cut into KERNEL_DOT_BLOCK sized blocks whose sums are computed in parallel and then added in
+// block order; the blocks do not depend on the number of threads, so neither does the result
+typedef struct struct_kernel_dot_product {
+    const void *m_op1;
+    const void *m_op2;
+    int64_t m_size;
+    void *m_partials;  // one sum per block
+} KernelDotProduct;
+
+static void kernelIntegerDotProductChunk(void *context, int64_t begin, int64_t end) {
+    KernelDotProduct *dot = context;
+    uint32_t *partials = dot->m_partials;
+    for (int64_t block = begin; block < end; block++) {
+        int64_t first = block * KERNEL_DOT_BLOCK;
+        int64_t length = dot->m_size - first < KERNEL_DOT_BLOCK ? dot->m_size - first : KERNEL_DOT_BLOCK;
+        partials[block] = kernelIntegerDotProductBlock((const int32_t *)dot->m_op1 + first, (const int32_t *)dot->m_op2 + first, length);
+    }
+}
+
+static void kernelRealDotProductChunk(void *context, int64_t begin, int64_t end) {
+    KernelDotProduct *dot = context;
+    float *partials = dot->m_partials;
+    for (int64_t block = begin; block < end; block++) {
+        int64_t first = block * KERNEL_DOT_BLOCK;
+        int64_t length = dot->m_size - first < KERNEL_DOT_BLOCK ? dot->m_size - first : KERNEL_DOT_BLOCK;
+        partials[block] = kernelRealDotProductBlock((const float *)dot->m_op1 + first, (const float *)dot->m_op2 + first, length);
+    }
+}
+
+int32_t kernelIntegerDotProduct(const int32_t *op1, const int32_t *op2, int64_t size) {
+    int64_t nBlock = (size + KERNEL_DOT_BLOCK - 1) / KERNEL_DOT_BLOCK;
+    if (nBlock <= 1)
+        return (int32_t)kernelIntegerDotProductBlock(op1, op2, size);
+    uint32_t *partials = malloc(nBlock * sizeof(uint32_t));
+    KernelDotProduct dot = {op1, op2, size, partials};
+    threadPoolParallelFor(nBlock, KERNEL_DOT_BLOCK, kernelIntegerDotProductChunk, &dot);
+    uint32_t sum = 0;
+    for (int64_t block = 0; block < nBlock; block++)
+        sum += partials[block];
+    free(partials);
+    return (int32_t)sum;
+}
+
+float kernelRealDotProduct(const float *op1, const float *op2, int64_t size) {
+    int64_t nBlock = (size + KERNEL_DOT_BLOCK - 1) / KERNEL_DOT_BLOCK;
+    if (nBlock <= 1)
+        return kernelRealDotProductBlock(op1, op2, size);
+    float *partials = malloc(nBlock * sizeof(float));
+    KernelDotProduct dot = {op1, op2, size, partials};
+    threadPoolParallelFor(nBlock, KERNEL_DOT_BLOCK, kernelRealDotProductChunk, &dot);
+    float sum = kernelRealSumPartials(partials, nBlock);
+    free(partials);
+    return sum;
+}
+
+// packs rows x depth of a row major matrix into panels of KERNEL_GEMM_MR rows stored column by column, so the
+// micro-kernel reads op1 sequentially; rows past the end of the matrix are padded with zeros
+// int32_t and float have the same size, so packing is shared by both element types
+static void kernelPackRows(const uint32_t *matrix, int64_t rowLength, int64_t rows, int64_t depth, uint32_t *packed) {
+    for (int64_t panel = 0; panel < rows; panel += KERNEL_GEMM_MR) {
+        for (int64_t p = 0; p < depth; p++) {
+            for (int64_t i = 0; i < KERNEL_GEMM_MR; i++)
+                *packed++ = panel + i < rows ? matrix[(panel + i) * rowLength + p] : 0;
+        }
+    }
+}
+
+// packs depth x cols of a row major matrix into panels of KERNEL_GEMM_NR columns stored row by row
+static void kernelPackColumns(const uint32_t *matrix, int64_t rowLength, int64_t depth, int64_t cols, uint32_t *packed) {
+    for (int64_t panel = 0; panel < cols; panel += KERNEL_GEMM_NR) {
+        for (int64_t p = 0; p < depth; p++) {
+            for (int64_t j = 0; j < KERNEL_GEMM_NR; j++)
+                *packed++ = panel + j < cols ? matrix[p * rowLength + panel + j] : 0;
+        }
+    }
+}
+
+// adds the product of an MR x depth row panel and a depth x NR column panel to the rows x cols corner of result
+typedef void (*KernelMicroKernel)(int64_t depth, const void *packedRows, const void *packedColumns, void *result,
+                                  int64_t rowLength, int64_t rows, int64_t cols);
+
+KERNEL_GEMM_TARGET_CLONES
+static void kernelIntegerMicroKernel(int64_t depth, const void *packedRows, const void *packedColumns, void *result,
+                                     int64_t rowLength, int64_t rows, int64_t cols) {
+    const int32_t *restrict a = packedRows;
+    const int32_t *restrict b = packedColumns;
+    int32_t *c = result;
+    int32_t tile[KERNEL_GEMM_MR][KERNEL_GEMM_NR];
+    for (int64_t i = 0; i < KERNEL_GEMM_MR; i++) {
+        for (int64_t j = 0; j < KERNEL_GEMM_NR; j++)
+            tile[i][j] = i < rows && j < cols ? c[i * rowLength + j] : 0;
+    }
+    for (int64_t p = 0; p < depth; p++) {
+        for (int64_t i = 0; i < KERNEL_GEMM_MR; i++) {
+            int32_t ai = a[p * KERNEL_GEMM_MR + i];
+            for (int64_t j = 0; j < KERNEL_GEMM_NR; j++)
+                tile[i][j] += ai * b[p * KERNEL_GEMM_NR + j];
+        }
+    }
+    for (int64_t i = 0; i < rows; i++) {
+        for (int64_t j = 0; j < cols; j++)
+            c[i * rowLength + j] = tile[i][j];
+    }
+}
+
+KERNEL_GEMM_TARGET_CLONES
+static void kernelRealMicroKernel(int64_t depth, const void *packedRows, const void *packedColumns, void *result,
+                                  int64_t rowLength, int64_t rows, int64_t cols) {
+    const float *restrict a = packedRows;
+    const float *restrict b = packedColumns;
+    float *c = result;
+    float tile[KERNEL_GEMM_MR][KERNEL_GEMM_NR];
+    for (int64_t i = 0; i < KERNEL_GEMM_MR; i++) {
+        for (int64_t j = 0; j < KERNEL_GEMM_NR; j++)
+            tile[i][j] = i < rows && j < cols ? c[i * rowLength + j] : 0.0f;
+    }
+    for (int64_t p = 0; p < depth; p++) {
+        for (int64_t i = 0; i < KERNEL_GEMM_MR; i++) {
+            float ai = a[p * KERNEL_GEMM_MR + i];
+            for (int64_t j = 0; j < KERNEL_GEMM_NR; j++)
+                tile[i][j] += ai * b[p * KERNEL_GEMM_NR + j];
+        }
+    }
+    for (int64_t i = 0; i < rows; i++) {
+        for (int64_t j = 0; j < cols; j++)
+            c[i * rowLength + j] = tile[i][j];
+    }
+}
+
+typedef struct struct_kernel_matrix_multiply {
+    const uint32_t *m_op1;
+    const uint32_t *m_packedColumns;
+    uint32_t *m_result;
+    int64_t m_n, m_m, m_k;
+    int64_t m_jc, m_pc, m_nc, m_kc;  // the block of op2 in m_packedColumns
+    KernelMicroKernel m_microKernel;
+} KernelMatrixMultiply;
+
+// multiplies row blocks [begin, end) of op1 by the packed block of op2; row blocks write disjoint rows of result,
+// so they can run on different threads
+static void kernelMatrixMultiplyRowBlocks(void *context, int64_t begin, int64_t end) {
+    KernelMatrixMultiply *mm = context;
+    uint32_t *packedRows = malloc(KERNEL_GEMM_MC * KERNEL_GEMM_KC * sizeof(uint32_t));
+    for (int64_t block = begin; block < end; block++) {
+        int64_t ic = block * KERNEL_GEMM_MC;
+        int64_t mc = mm->m_n - ic < KERNEL_GEMM_MC ? mm->m_n - ic : KERNEL_GEMM_MC;
+        kernelPackRows(mm->m_op1 + ic * mm->m_m + mm->m_pc, mm->m_m, mc, mm->m_kc, packedRows);
+        for (int64_t jr = 0; jr < mm->m_nc; jr += KERNEL_GEMM_NR) {
+            for (int64_t ir = 0; ir < mc; ir += KERNEL_GEMM_MR) {
+                int64_t rows = mc - ir < KERNEL_GEMM_MR ? mc - ir : KERNEL_GEMM_MR;
+                int64_t cols = mm->m_nc - jr < KERNEL_GEMM_NR ? mm->m_nc - jr : KERNEL_GEMM_NR;
+                mm->m_microKernel(mm->m_kc, packedRows + ir * mm->m_kc, mm->m_packedColumns + jr * mm->m_kc,
+                                  mm->m_result + (ic + ir) * mm->m_k + mm->m_jc + jr, mm->m_k, rows, cols);
+            }
+        }
+    }
+    free(packedRows);
+}
+
+// the depth blocks are visited in order and each tile is reloaded from result, so every element still
+// accumulates op1[i][0] * op2[0][j], op1[i][1] * op2[1][j], ... one after the other
+static void kernelMatrixMultiplyBlocked(const uint32_t *op1, const uint32_t *op2, uint32_t *result,
+                                        int64_t n, int64_t m, int64_t k, KernelMicroKernel microKernel) {
+    uint32_t *packedColumns = malloc(KERNEL_GEMM_KC * KERNEL_GEMM_NC * sizeof(uint32_t));
+    KernelMatrixMultiply mm = {op1, packedColumns, result, n, m, k, 0, 0, 0, 0, microKernel};
+    int64_t nRowBlock = (n + KERNEL_GEMM_MC - 1) / KERNEL_GEMM_MC;
+    for (mm.m_jc = 0; mm.m_jc < k; mm.m_jc += KERNEL_GEMM_NC) {
+        mm.m_nc = k - mm.m_jc < KERNEL_GEMM_NC ? k - mm.m_jc : KERNEL_GEMM_NC;
+        for (mm.m_pc = 0; mm.m_pc < m; mm.m_pc += KERNEL_GEMM_KC) {
+            mm.m_kc = m - mm.m_pc < KERNEL_GEMM_KC ? m - mm.m_pc : KERNEL_GEMM_KC;
+            kernelPackColumns(op2 + mm.m_pc * k + mm.m_jc, k, mm.m_kc, mm.m_nc, packedColumns);
+            threadPoolParallelFor(nRowBlock, KERNEL_GEMM_MC * mm.m_kc * mm.m_nc, kernelMatrixMultiplyRowBlocks, &mm);
+        }
+    }
+    free(packedColumns);
+}
+
+void kernelIntegerMatrixMultiply(const int32_t *op1, const int32_t *op2, int32_t *result, int64_t n, int64_t m, int64_t k) {
+    if (n * m * k >= KERNEL_GEMM_MIN_VOLUME) {
+        kernelMatrixMultiplyBlocked((const uint32_t *)op1, (const uint32_t *)op2, (uint32_t *)result, n, m, k, kernelIntegerMicroKernel);
+        return;
+    }
+    // i-l-j order walks op2 and result along rows instead of striding down the columns of op2
+    for (int64_t i = 0; i < n; i++) {
+        for (int64_t l = 0; l < m; l++) {
+            int32_t a = op1[i * m + l];
+            for (int64_t j = 0; j < k; j++)
+                result[i * k + j] += a * op2[l * k + j];
+        }
+    }
+}
+
+void kernelRealMatrixMultiply(const float *op1, const float *op2, float *result, int64_t n, int64_t m, int64_t k) {
+    if (n * m * k >= KERNEL_GEMM_MIN_VOLUME) {
+        kernelMatrixMultiplyBlocked((const uint32_t *)op1, (const uint32_t *)op2, (uint32_t *)result, n, m, k, kernelRealMicroKernel);
+        return;
+    }
+    for (int64_t i = 0; i < n; i++) {
+        for (int64_t l = 0; l < m; l++) {
+            float a = op1[i * m + l];
+            for (int64_t j = 0; j < k; j++)
+                result[i * k + j] += a * op2[l * k + j];
+        }
+    }
+}
+
+typedef struct struct_kernel_fused_expression {
+    ElementTypeID m_eid;
+    KernelRange m_range;
+    const int32_t *m_program;
+    int32_t m_programLength;
+    const char **m_operands;
+    const int64_t *m_operandStrides;
+    char *m_result;
+    atomic_bool m_failed;  // set by the first chunk that runs into an element raising an error
+} KernelFusedExpression;
+
+// the integer checks kernelIntegerBinOp does before splitting a loop, done here for one block at a time
+static bool kernelFusedIntegerCanCompute(int32_t opcode, const int32_t *op1, int64_t op1Stride, const int32_t *op2,
+                                         int64_t op2Stride, int64_t size) {
+    switch (opcode) {
+        case BINARY_DIVIDE:
+        case BINARY_REMAINDER:
+            return !kernelIntegerHasZero(op2, op2Stride, size);
+        case BINARY_EXPONENT:
+            return !kernelIntegerHasZeroToNegativePower(op1, op1Stride, op2, op2Stride, size);
+        default:
+            return true;
+    }
+}
+
+// each stack slot computes into its own buffer; an operation writes into the spare buffer and swaps it with the one
+// of the slot it leaves its value in, since the range kernels must not write over their operands
+static void kernelFusedExpressionChunk(void *context, int64_t begin, int64_t end) {
+    KernelFusedExpression *fused = context;
+    const int64_t elementSize = sizeof(int32_t);  // same as sizeof(float)
+    char *storage = malloc((KERNEL_FUSED_MAX_DEPTH + 1) * KERNEL_FUSED_BLOCK * elementSize);
+    char *buffers[KERNEL_FUSED_MAX_DEPTH];
+    for (int32_t slot = 0; slot < KERNEL_FUSED_MAX_DEPTH; slot++)
+        buffers[slot] = storage + slot * KERNEL_FUSED_BLOCK * elementSize;
+    char *spare = storage + KERNEL_FUSED_MAX_DEPTH * KERNEL_FUSED_BLOCK * elementSize;
+
+    const char *values[KERNEL_FUSED_MAX_DEPTH];
+    int64_t strides[KERNEL_FUSED_MAX_DEPTH];
+    for (int64_t blockBegin = begin; blockBegin < end; blockBegin += KERNEL_FUSED_BLOCK) {
+        if (atomic_load_explicit(&fused->m_failed, memory_order_relaxed))
+            break;
+        int64_t size = end - blockBegin < KERNEL_FUSED_BLOCK ? end - blockBegin : KERNEL_FUSED_BLOCK;
+        int32_t top = 0;
+        for (int32_t pc = 0; pc < fused->m_programLength; pc++) {
+            int32_t instruction = fused->m_program[pc];
+            if (instruction < 0) {
+                int32_t operand = -1 - instruction;
+                strides[top] = fused->m_operandStrides[operand];
+                values[top] = fused->m_operands[operand] + blockBegin * strides[top] * elementSize;
+                top++;
+                continue;
+            }
+            top--;
+            if (fused->m_eid == ELEMENT_INTEGER
+                && !kernelFusedIntegerCanCompute(instruction, (const int32_t *)values[top - 1], strides[top - 1],
+                                                 (const int32_t *)values[top], strides[top], size)) {
+                atomic_store(&fused->m_failed, true);
+                break;
+            }
+            // the last instruction is the root of the expression and writes the result directly
+            char *destination = pc == fused->m_programLength - 1 ? fused->m_result + blockBegin * elementSize : spare;
+            fused->m_range(instruction, values[top - 1], strides[top - 1], values[top], strides[top], size, destination);
+            if (destination == spare) {
+                spare = buffers[top - 1];
+                buffers[top - 1] = destination;
+            }
+            values[top - 1] = destination;
+            strides[top - 1] = 1;
+        }
+    }
+    free(storage);
+}
+
+bool kernelFusedExpression(ElementTypeID eid, const int32_t *program, int32_t programLength, const void **operands,
+                           const int64_t *operandStrides, int64_t size, void *result) {
+    KernelFusedExpression fused;
+    fused.m_eid = eid;
+    fused.m_range = eid == ELEMENT_INTEGER ? kernelIntegerBinOpRange : kernelRealBinOpRange;
+    fused.m_program = program;
+    fused.m_programLength = programLength;
+    fused.m_operands = (const char **)operands;
+    fused.m_operandStrides = operandStrides;
+    fused.m_result = result;
+    atomic_init(&fused.m_failed, false);
+    threadPoolParallelFor(size, programLength, kernelFusedExpressionChunk, &fused);
+    return !atomic_load(&fused.m_failed);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * Typed loops behind the element-wise array operations in NDArray.c
+ * Every kernel writes into a caller provided buffer and does no type checking; the caller resolves the element type
+ * and makes sure the result buffer holds size elements of the result type
+ * Loops above the thread pool's threshold are split across its threads, see ThreadPool.h
+ */
+
+#include <stdint.h>
+#include "Bool.h"
+#include "Enums.h"
+
+// On x86-64 each kernel is compiled once per instruction set below and the dynamic loader picks the widest one the
+// running CPU supports, so the same binary uses AVX2 where it is available and plain SSE2 everywhere else
+#if defined(__x86_64__) && defined(__ELF__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define KERNEL_TARGET_CLONES __attribute__((target_clones("avx2", "sse4.1", "default")))
+#endif
+#endif
+#ifndef KERNEL_TARGET_CLONES
+#define KERNEL_TARGET_CLONES
+#endif
+// matrix multiplication is compute bound, so its micro-kernel also gets an AVX-512 clone
+#if defined(__x86_64__) && defined(__ELF__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define KERNEL_GEMM_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "sse4.1", "default")))
+#endif
+#endif
+#ifndef KERNEL_GEMM_TARGET_CLONES
+#define KERNEL_GEMM_TARGET_CLONES
+#endif
+
+// summation order of the real dot product; each one gives the same result on every CPU the kernel can run on
+#define KERNEL_SUMMATION_MULTI_ACCUMULATOR 0  // KERNEL_DOT_LANES independent partial sums, fastest
+#define KERNEL_SUMMATION_PAIRWISE 1           // partial sums of blocks added as a tree, error grows with log n
+#define KERNEL_SUMMATION_KAHAN 2              // compensated partial sums, error does not grow with n
+#ifndef KERNEL_REAL_SUMMATION
+#define KERNEL_REAL_SUMMATION KERNEL_SUMMATION_MULTI_ACCUMULATOR
+#endif
+
+#define KERNEL_DOT_LANES 32           // four AVX2 registers worth of floats, so the adds do not wait on each other
+#define KERNEL_PAIRWISE_BLOCK 256     // pairwise summation falls back to the lanes below this many elements
+#define KERNEL_DOT_BLOCK 65536        // elements per independently summed block of a long dot product
+
+// matrix multiplication tiling; the micro-kernel keeps an MR x NR tile of the result in registers while the
+// packed KC x NR panel of op2 stays in L1, the MC x KC block of op1 in L2 and the KC x NC block of op2 in L3
+#define KERNEL_GEMM_MR 6
+#define KERNEL_GEMM_NR 16
+#define KERNEL_GEMM_KC 256
+#define KERNEL_GEMM_MC 96             // multiple of KERNEL_GEMM_MR
+#define KERNEL_GEMM_NC 2048           // multiple of KERNEL_GEMM_NR
+#define KERNEL_GEMM_MIN_VOLUME 32768  // n * m * k below which packing costs more than it saves
+
+// fused expressions are evaluated KERNEL_FUSED_BLOCK elements at a time, so their intermediate values stay in L1
+#define KERNEL_FUSED_MAX_DEPTH 8      // values on the evaluation stack, mirrored by LLVMGen
+#define KERNEL_FUSED_BLOCK 512
+
+/// element-wise binary op
+// a stride of 0 broadcasts a scalar operand over the other one, a stride of 1 walks a contiguous array
+// comparisons write bool, everything else writes the operand type
+void kernelIntegerBinOp(BinOpCode opcode, const int32_t *op1, int64_t op1Stride, const int32_t *op2, int64_t op2Stride, int64_t size, void *result);
+void kernelRealBinOp(BinOpCode opcode, const float *op1, int64_t op1Stride, const float *op2, int64_t op2Stride, int64_t size, void *result);
+void kernelBooleanBinOp(BinOpCode opcode, const bool *op1, int64_t op1Stride, const bool *op2, int64_t op2Stride, int64_t size, bool *result);
+
+/// unary op
+void kernelIntegerUnaryOp(UnaryOpCode opcode, const int32_t *src, int64_t size, int32_t *result);
+void kernelRealUnaryOp(UnaryOpCode opcode, const float *src, int64_t size, float *result);
+void kernelBooleanUnaryOp(UnaryOpCode opcode, const bool *src, int64_t size, bool *result);  // only UNARY_NOT
+
+/// dot product
+int32_t kernelIntegerDotProduct(const int32_t *op1, const int32_t *op2, int64_t size);  // wraps around like scalar +
+float kernelRealDotProduct(const float *op1, const float *op2, int64_t size);  // sums in KERNEL_REAL_SUMMATION order
+
+/// matrix multiplication
+// n * m matrix op1 times m * k matrix op2, both row major; the product is added to the n * k matrix result,
+// which the caller zeroes. Each element is summed in the same order as the textbook triple loop
+void kernelIntegerMatrixMultiply(const int32_t *op1, const int32_t *op2, int32_t *result, int64_t n, int64_t m, int64_t k);
+void kernelRealMatrixMultiply(const float *op1, const float *op2, float *result, int64_t n, int64_t m, int64_t k);
+
+/// fused element-wise expression
+// program is an expression in postfix order: an entry k >= 0 applies BinOpCode k to the top two values of the stack
+// and an entry -1 - k pushes operands[k]. Only arithmetic opcodes are allowed, so every value has the element type
+// eid (integer or real); operandStrides[k] is 0 for a scalar operand and 1 for an array of size elements.
+// Returns false, leaving result incomplete, when an element would raise a runtime error such as division by zero;
+// the caller then redoes the expression one operation at a time so the error is the one the unfused expression raises
+bool kernelFusedExpression(ElementTypeID eid, const int32_t *program, int32_t programLength, const void **operands,
+                           const int64_t *operandStrides, int64_t size, void *result);
@@ -104,6 +104,18 @@ typedef enum enum_binary_op_code {
     NUM_BINARY_OPS
 } BinOpCode;                            /// INTERFACE
 
+/// canonical immutable types shared by all users, see internedTypes
+typedef enum enum_gazprea_interned_type_id {
+    INTERNED_TYPE_BOOLEAN_SCALAR,
+    INTERNED_TYPE_CHARACTER_SCALAR,
+    INTERNED_TYPE_INTEGER_SCALAR,
+    INTERNED_TYPE_REAL_SCALAR,
+    INTERNED_TYPE_INTEGER_INTERVAL,
+    INTERNED_TYPE_UNKNOWN,
+
+    NUM_INTERNED_TYPES
+} InternedTypeID;                       /// INTERFACE
+
 typedef enum enum_gazprea_stack_item_type {
     STACK_ITEM_VARIABLE,
     STACK_ITEM_TYPE,
@@ -125,6 +125,14 @@ void variableInitFromCharacterScalar(Variable *this, int8_t value){
     variableInitFromNDArray(this, false, ELEMENT_CHARACTER, 0, NULL, &value, false);
 }
 
+void variableInitFromIntegerInterval(Variable *this, int32_t head, int32_t tail) {
+    this->m_type = typeMalloc();
+    typeInitFromIntegerInterval(this->m_type);
+    this->m_data = variableMallocData(this, INTERVAL_DATA_SIZE);
+    intervalTypeInitDataFromHeadTail(this->m_data, head, tail);
+    variableAttrInitHelper(this, -1, this->m_data, false);
+}
+
 void variableInitFromNullScalar(Variable *this) {
     variableInitFromNDArray(this, false, ELEMENT_NULL, 0, NULL, NULL, false);
 }
@@ -134,7 +142,7 @@ void variableInitFromIdentityScalar(Variable *this){
 }
 
 void variableInitFromMatrixLiteralHelper(Variable *this, int64_t nVars, Variable **vars, int64_t longestLen) {
-    MixedTypeElement mixedTemplate = {ELEMENT_NULL, NULL };
+    MixedTypeElement mixedTemplate = {ELEMENT_NULL };
     int64_t dims[2] = {nVars, longestLen};
     this->m_type = typeMalloc();
     typeInitFromArrayType(this->m_type, false, ELEMENT_MIXED, 2, dims);
@@ -154,9 +162,7 @@ void variableInitFromMatrixLiteralHelper(Variable *this, int64_t nVars, Variable
                 ElementTypeID eid = CTI->m_elementTypeID;
                 void *elementPtr = arrayGetElementPtrAtIndex(eid, curVar->m_data, j);
                 if (eid == ELEMENT_MIXED) {
-                    MixedTypeElement *element = elementPtr;
-                    mixedTypeElementInitFromValue(curElement, element->m_elementTypeID,
-                                                  element->m_element);
+                    *curElement = *(MixedTypeElement *)elementPtr;
                 } else {
                     mixedTypeElementInitFromValue(curElement, eid, elementPtr);
                 }
@@ -225,7 +231,7 @@ void variableInitFromVectorLiteral(Variable *this, int64_t nVars, Variable **var
     } else {
         // vector literal
         this->m_type = typeMalloc();
-        MixedTypeElement mixedTemplate = {ELEMENT_NULL, NULL };
+        MixedTypeElement mixedTemplate = {ELEMENT_NULL };
         int64_t dims[1] = {nVars};
         typeInitFromArrayType(this->m_type, false, ELEMENT_MIXED, 1, dims);
         MixedTypeElement *arr = arrayMallocFromElementValue(ELEMENT_MIXED, nVars, &mixedTemplate);
@@ -264,6 +270,23 @@ void variableInitFromVectorLiteral(Variable *this, int64_t nVars, Variable **var
     free(modifiedVars);
 }
 
+void variableInitFromConstantArray(Variable *this, bool isString, ElementTypeID eid, int8_t nDim, int64_t dim1, int64_t dim2,
+                                   void *values, int32_t *refCount) {
+    int64_t dims[2] = {dim1, dim2};
+    this->m_type = typeMalloc();
+    typeInitFromArrayType(this->m_type, isString, eid, nDim, dims);
+    ArrayType *CTI = this->m_type->m_compoundTypeInfo;
+    free(CTI->m_refCount);
+    CTI->m_refCount = refCount;
+    CTI->m_isLiteral = true;
+    arrayTypeIncReferenceCount(CTI);
+    this->m_data = values;
+    variableAttrInitHelper(this, -1, this->m_data, false);
+#ifdef DEBUG_PRINT
+    variableInitDebugPrint(this, "from constant array");
+#endif
+}
+
 void variableInitFromString(Variable *this, int64_t strLength, int8_t *str) {
     int64_t dims[1] = {strLength};
     variableInitFromNDArray(this, true, ELEMENT_CHARACTER, 1, dims, str, false);
@@ -302,7 +325,7 @@ void variableInitFromStdOutput(Variable *this) {
 
 void variableInitFromEmptyArray(Variable *this) {
     this->m_type = typeMalloc();
-    MixedTypeElement mixedTemplate = {ELEMENT_NULL, NULL };
+    MixedTypeElement mixedTemplate = {ELEMENT_NULL };
     typeInitFromArrayType(this->m_type, false, ELEMENT_MIXED, DIM_UNSPECIFIED, NULL);
     this->m_data = arrayMallocFromElementValue(ELEMENT_MIXED, 0, &mixedTemplate);;
     variableAttrInitHelper(this, -1, this->m_data, false);
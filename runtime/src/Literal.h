@@ -54,9 +54,19 @@ void variableInitFromBooleanScalar(Variable *this, bool value);
 void variableInitFromIntegerScalar(Variable *this, int32_t value);
 void variableInitFromRealScalar(Variable *this, float value);
 void variableInitFromCharacterScalar(Variable *this, int8_t value);
+void variableInitFromIntegerInterval(Variable *this, int32_t head, int32_t tail);  // interval with constant bounds
 void variableInitFromNullScalar(Variable *this);
 void variableInitFromIdentityScalar(Variable *this);
 void variableInitFromVectorLiteral(Variable *this, int64_t nVars, Variable **vars);  // could be either vector or matrix literal
+/**
+ * Initialize a vector, matrix or string from a literal whose elements are emitted as constant data by the compiler.
+ * The variable is a copy-on-write view of values: it is never written to or freed, and the first write copies it
+ * @param nDim 1 or 2, dim2 is ignored for vectors
+ * @param values the elements in row-major order
+ * @param refCount the literal's own counters, emitted as {1, 1}; the permanent owner keeps values shared
+ */
+void variableInitFromConstantArray(Variable *this, bool isString, ElementTypeID eid, int8_t nDim, int64_t dim1, int64_t dim2,
+                                   void *values, int32_t *refCount);
 // string
 void variableInitFromString(Variable *this, int64_t strLength, int8_t *str);
 // tuple
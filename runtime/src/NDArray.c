@@ -1,4 +1,6 @@
 #include "NDArray.h"
+#include "ArrayKernels.h"
+#include "ThreadPool.h"
 #include "RuntimeErrors.h"
 #include "math.h"
 #include "string.h"
@@ -9,29 +11,23 @@ void mixedTypeElementInitFromValue(MixedTypeElement *this, ElementTypeID eid, vo
         case ELEMENT_INTEGER:
         case ELEMENT_REAL:
         case ELEMENT_BOOLEAN:
-        case ELEMENT_CHARACTER: {
+        case ELEMENT_CHARACTER:
             this->m_elementTypeID = eid;
-            int64_t elementSize = elementGetSize(eid);
-            this->m_element = malloc(elementSize);
-            elementAssign(eid, this->m_element, value);
-        } break;
+            elementAssign(eid, &this->m_value, value); break;
         case ELEMENT_NULL:
         case ELEMENT_IDENTITY:
-            this->m_elementTypeID = eid;
-            this->m_element = NULL; break;
-        case ELEMENT_MIXED: {
-            MixedTypeElement *other = value;
-            this->m_elementTypeID = other->m_elementTypeID;
-            int64_t elementSize = elementGetSize(other->m_elementTypeID);
-            void *otherValue = other->m_element;
-            this->m_element = malloc(elementSize);
-            elementAssign(other->m_elementTypeID, this->m_element, otherValue);
-        }
+            this->m_elementTypeID = eid; break;
+        case ELEMENT_MIXED:
+            *this = *(MixedTypeElement *)value; break;
         default:
             errorAndExit("Invalid eid for element of mixed array!");
     }
 }
 
+void *mixedTypeElementGetValuePtr(MixedTypeElement *this) {
+    return elementIsBasicType(this->m_elementTypeID) ? &this->m_value : NULL;
+}
+
 bool elementIsMixedType(ElementTypeID id) {
     return id == ELEMENT_MIXED;
 }
@@ -72,15 +68,8 @@ void elementAssign(ElementTypeID id, void *target, void *src) {
             *(bool *)target = *(bool *)src; break;
         case ELEMENT_CHARACTER:
             *(int8_t *)target = *(int8_t *)src; break;
-        case ELEMENT_MIXED: {
-            MixedTypeElement *targetElement = target;
-            MixedTypeElement *srcElement = src;
-
-            ElementTypeID newID = srcElement->m_elementTypeID;
-            arrayFree(targetElement->m_elementTypeID, targetElement->m_element, 1);
-            targetElement->m_elementTypeID = newID;
-            mixedTypeElementInitFromValue(targetElement, newID, srcElement->m_element);
-        } break;
+        case ELEMENT_MIXED:
+            *(MixedTypeElement *)target = *(MixedTypeElement *)src; break;
         default: break;
     }
 }
@@ -455,18 +444,9 @@ void *arrayMallocFromElementValue(ElementTypeID id, int64_t size, void *value) {
     if (elementIsBasicType(id) || id == ELEMENT_MIXED) {
         int64_t elementSize = elementGetSize(id);
         char *target = malloc(elementSize * size);
-
-        if (id == ELEMENT_MIXED) {
-            MixedTypeElement *element = value;
-            for (int64_t i = 0; i < size; i++) {
-                MixedTypeElement *curTarget = (void *)(target + i * elementSize);
-                mixedTypeElementInitFromValue(curTarget, element->m_elementTypeID, element->m_element);
-            }
-        } else {
-            for (int64_t i = 0; i < size; i++) {
-                void *curTarget = target + i * elementSize;
-                memcpy(curTarget, value, elementSize);
-            }
+        for (int64_t i = 0; i < size; i++) {
+            void *curTarget = target + i * elementSize;
+            memcpy(curTarget, value, elementSize);
         }
         return (void *)target;
     }
@@ -474,20 +454,11 @@ void *arrayMallocFromElementValue(ElementTypeID id, int64_t size, void *value) {
 }
 
 void *arrayMallocFromMemcpy(ElementTypeID id, int64_t size, void *value) {
-    if (elementIsBasicType(id)) {
+    if (elementIsBasicType(id) || elementIsMixedType(id)) {
         int64_t elementSize = elementGetSize(id);
         void *target = malloc(elementSize * size);
         memcpy(target, value, elementSize * size);
         return target;
-    } else if (elementIsMixedType(id)) {
-        int64_t elementSize = elementGetSize(id);
-        char *target = malloc(elementSize * size);
-        char *src = value;
-        for (int64_t i = 0; i < size; i++) {
-            MixedTypeElement *element = (void *)(src + i * elementSize);
-            mixedTypeElementInitFromValue((void *)(target + i * elementSize), element->m_elementTypeID, element->m_element);
-        }
-        return target;
     }
     return NULL;
 }
@@ -519,16 +490,8 @@ void *arrayMallocFromRealValue(int64_t size, float value) {
 }
 
 void arrayFree(ElementTypeID id, void *arr, int64_t size) {
-    if (elementIsBasicType(id)) {
-        free(arr);
-    } else if (elementIsMixedType(id)) {
-        MixedTypeElement *ptr = arr;
-        for (int64_t i = 0; i < size; i++) {
-            if (elementIsBasicType(ptr[i].m_elementTypeID))
-                free(ptr[i].m_element);
-        }
-        // then free the pointer array itself
-        free(arr);
+    if (elementIsBasicType(id) || elementIsMixedType(id)) {
+        free(arr);  // mixed elements hold their values inline
     }
 }
 
@@ -558,23 +521,16 @@ void arrayMallocFromUnaryOp(ElementTypeID id, UnaryOpCode opcode, void *src, int
         errorAndExit("Invalid unary operand type!");
     }
     if (id == ELEMENT_BOOLEAN) {
-        bool *resultArray = arrayMallocFromNull(id, length);
-        for (int64_t i = 0; i < length; i++)
-            resultArray[i] = !arrayGetBoolValue(src, i);
+        bool *resultArray = malloc(length * sizeof(bool));
+        kernelBooleanUnaryOp(opcode, src, length, resultArray);
         *result = resultArray;
     } else if (id == ELEMENT_INTEGER) {
-        int32_t *resultArray = arrayMallocFromNull(id, length);
-        for (int64_t i = 0; i < length; i++) {
-            int32_t value = arrayGetIntegerValue(src, i);
-            resultArray[i] = (opcode == UNARY_MINUS) ? -value : value;
-        }
+        int32_t *resultArray = malloc(length * sizeof(int32_t));
+        kernelIntegerUnaryOp(opcode, src, length, resultArray);
         *result = resultArray;
     } else if (id == ELEMENT_REAL) {
-        float *resultArray = arrayMallocFromNull(id, length);
-        for (int64_t i = 0; i < length; i++) {
-            float value = arrayGetRealValue(src, i);
-            resultArray[i] = (opcode == UNARY_MINUS) ? -value : value;
-        }
+        float *resultArray = malloc(length * sizeof(float));
+        kernelRealUnaryOp(opcode, src, length, resultArray);
         *result = resultArray;
     } else if (id == ELEMENT_MIXED) {
         ElementTypeID eid;
@@ -682,18 +638,11 @@ void arrayMallocFromBinOp(ElementTypeID id, BinOpCode opcode, void *op1, int64_t
     } else if (opcode == BINARY_DOT_PRODUCT) {
         resultArraySize = 1;
 
-        void *sum = arrayMallocFromNull(resultEID, 1);
-        for (int64_t i = 0; i < op1Size; i++) {
-            // sum += op1[i] * op2[i]
-            void *temp;
-            void *tempSum;
-            elementMallocFromBinOp(id, BINARY_MULTIPLY, op1Pos + i * elementSize, op2Pos + i * elementSize, &temp);
-            elementMallocFromBinOp(resultEID, BINARY_PLUS, sum, temp, &tempSum);
-            free(temp);
-            free(sum);
-            sum = tempSum;
+        if (id == ELEMENT_INTEGER) {
+            resultPos = arrayMallocFromIntegerValue(1, kernelIntegerDotProduct((int32_t *)op1Pos, (int32_t *)op2Pos, op1Size));
+        } else {
+            resultPos = arrayMallocFromRealValue(1, kernelRealDotProduct((float *)op1Pos, (float *)op2Pos, op1Size));
         }
-        resultPos = sum;
     } else if (opcode == BINARY_EQ || opcode == BINARY_NE) {
         resultArraySize = 1;
 
@@ -705,11 +654,15 @@ void arrayMallocFromBinOp(ElementTypeID id, BinOpCode opcode, void *op1, int64_t
     } else {  // for other operators, this is same as scalar case i.e. the binop is done element-wise
         resultArraySize = op1Size;
         resultPos = malloc(resultArraySize * resultElementSize);
-        for (int64_t i = 0; i < resultArraySize; i++) {
-            void *temp;
-            elementMallocFromBinOp(id, opcode, op1Pos + i * elementSize, op2Pos + i * elementSize, &temp);
-            memcpy(resultPos + i * resultElementSize, temp, resultElementSize);
-            free(temp);
+        switch (id) {
+            case ELEMENT_INTEGER:
+                kernelIntegerBinOp(opcode, (int32_t *)op1Pos, 1, (int32_t *)op2Pos, 1, resultArraySize, resultPos); break;
+            case ELEMENT_REAL:
+                kernelRealBinOp(opcode, (float *)op1Pos, 1, (float *)op2Pos, 1, resultArraySize, resultPos); break;
+            case ELEMENT_BOOLEAN:
+                kernelBooleanBinOp(opcode, (bool *)op1Pos, 1, (bool *)op2Pos, 1, resultArraySize, (bool *)resultPos); break;
+            default:
+                errorAndExit("This should not happen!"); break;
         }
     }
     *result = resultPos;
@@ -717,6 +670,47 @@ void arrayMallocFromBinOp(ElementTypeID id, BinOpCode opcode, void *op1, int64_t
         *resultSize = resultArraySize;
 }
 
+static bool arrayBinOpIsComparison(BinOpCode opcode) {
+    return opcode == BINARY_LT || opcode == BINARY_BT || opcode == BINARY_LEQ || opcode == BINARY_BEQ;
+}
+
+// same as the element-wise branch of arrayMallocFromBinOp, but an operand can be a broadcast scalar
+void arrayMallocFromIntegerBinOp(BinOpCode opcode, int32_t *op1, int64_t op1Stride, int32_t *op2, int64_t op2Stride, int64_t size, void **result) {
+    *result = malloc(size * (arrayBinOpIsComparison(opcode) ? sizeof(bool) : sizeof(int32_t)));
+    kernelIntegerBinOp(opcode, op1, op1Stride, op2, op2Stride, size, *result);
+}
+
+void arrayMallocFromRealBinOp(BinOpCode opcode, float *op1, int64_t op1Stride, float *op2, int64_t op2Stride, int64_t size, void **result) {
+    *result = malloc(size * (arrayBinOpIsComparison(opcode) ? sizeof(bool) : sizeof(float)));
+    kernelRealBinOp(opcode, op1, op1Stride, op2, op2Stride, size, *result);
+}
+
+typedef struct struct_array_conversion {
+    ElementTypeID m_resultID;
+    ElementTypeID m_srcID;
+    char *m_src;
+    int64_t m_srcElementSize;
+    char *m_result;
+    int64_t m_resultElementSize;
+    void (*m_conversion)(ElementTypeID, ElementTypeID, void*, void**);
+} ArrayConversion;
+
+static void arrayConvertElements(void *context, int64_t begin, int64_t end) {
+    ArrayConversion *arrayConversion = context;
+    for (int64_t i = begin; i < end; i++) {
+        void *temp;
+        arrayConversion->m_conversion(arrayConversion->m_resultID, arrayConversion->m_srcID,
+                                      arrayConversion->m_src + i * arrayConversion->m_srcElementSize, &temp);
+        memcpy(arrayConversion->m_result + i * arrayConversion->m_resultElementSize, temp, arrayConversion->m_resultElementSize);
+        free(temp);
+    }
+}
+
+// every element but the first
+static void arrayConvertRemainingElements(void *context, int64_t begin, int64_t end) {
+    arrayConvertElements(context, begin + 1, end + 1);
+}
+
 void arrayMallocFromCastPromote(ElementTypeID resultID, ElementTypeID srcID, int64_t size, void *src, void **result,
     void conversion(ElementTypeID, ElementTypeID, void*, void**)) {
     int64_t resultElementSize = elementGetSize(resultID);
@@ -726,19 +720,25 @@ void arrayMallocFromCastPromote(ElementTypeID resultID, ElementTypeID srcID, int
         MixedTypeElement *mixed = src;
         for (int64_t i = 0; i < size; i++) {
             ElementTypeID eid = mixed[i].m_elementTypeID;
+            void *valuePtr = mixedTypeElementGetValuePtr(mixed + i);
+            if (eid == resultID) {  // the common case of a homogeneous literal
+                elementAssign(resultID, resultPos + resultElementSize * i, valuePtr);
+                continue;
+            }
             void *temp;
-            conversion(resultID, eid, mixed[i].m_element, &temp);
+            conversion(resultID, eid, valuePtr, &temp);
             memcpy(resultPos + resultElementSize * i, temp, resultElementSize);
             free(temp);
         }
-    } else {
-        int64_t srcElementSize = elementGetSize(srcID);
-        char *srcPos = src;
-        for (int64_t i = 0; i < size; i++) {
-            void *temp;
-            conversion(resultID, srcID, srcPos + i * srcElementSize, &temp);
-            memcpy(resultPos + resultElementSize * i, temp, resultElementSize);
-            free(temp);
+    } else if (size > 0) {
+        // the first element goes through the calling thread, so a source type that can not be converted is
+        // reported from there; the rest can not fail since every element has the same type
+        ArrayConversion arrayConversion = {resultID, srcID, src, elementGetSize(srcID), resultPos, resultElementSize, conversion};
+        arrayConvertElements(&arrayConversion, 0, 1);
+        if (resultID == srcID) {
+            memcpy(resultPos, src, size * resultElementSize);
+        } else {
+            threadPoolParallelFor(size - 1, 1, arrayConvertRemainingElements, &arrayConversion);
         }
     }
     *result = resultPos;
@@ -773,33 +773,13 @@ bool arrayMixedElementCanBePromotedToSameType(MixedTypeElement *arr, int64_t siz
 // n * m matrix multiply by m * k matrix to produce a n * k matrix
 void arrayMallocFromMatrixMultiplication(ElementTypeID id, void *op1, void *op2, int64_t n, int64_t m, int64_t k, void **result) {
     if (id == ELEMENT_INTEGER) {
-        int32_t *mat1 = op1;
-        int32_t *mat2 = op2;
         int32_t *mat3 = arrayMallocFromNull(id, n * k);
-        for (int64_t i = 0; i < n; i++) {
-            for (int64_t j = 0; j < k; j++) {
-                int32_t sum = 0;
-                for (int64_t l = 0; l < m; l++) {
-                    sum += mat1[i * m + l] * mat2[l * k + j];
-                }
-                mat3[i * k + j] = sum;
-            }
-        }
+        kernelIntegerMatrixMultiply(op1, op2, mat3, n, m, k);
         *result = mat3;
         return;
     } else if (id == ELEMENT_REAL) {
-        float *mat1 = op1;
-        float *mat2 = op2;
         float *mat3 = arrayMallocFromNull(id, n * k);
-        for (int64_t i = 0; i < n; i++) {
-            for (int64_t j = 0; j < k; j++) {
-                float sum = 0;
-                for (int64_t l = 0; l < m; l++) {
-                    sum += mat1[i * m + l] * mat2[l * k + j];
-                }
-                mat3[i * k + j] = sum;
-            }
-        }
+        kernelRealMatrixMultiply(op1, op2, mat3, n, m, k);
         *result = mat3;
         return;
     }
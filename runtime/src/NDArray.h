@@ -10,12 +10,19 @@
 #include "Bool.h"
 #include "Enums.h"
 
+// an element of a mixed array stores its value inline, so building a literal does not allocate per element
 typedef struct struct_gazprea_mixed_type_element {
     ElementTypeID m_elementTypeID;
-    void *m_element;
+    union {
+        bool m_boolean;
+        int8_t m_character;
+        int32_t m_integer;
+        float m_real;
+    } m_value;  // unused for null and identity
 } MixedTypeElement;
 
 void mixedTypeElementInitFromValue(MixedTypeElement *this, ElementTypeID eid, void *value);
+void *mixedTypeElementGetValuePtr(MixedTypeElement *this);  // NULL for null and identity
 
 bool elementIsMixedType(ElementTypeID id);
 bool elementIsNullIdentity(ElementTypeID id);
@@ -35,6 +42,7 @@ void elementMallocFromCast(ElementTypeID resultID, ElementTypeID srcID, void *sr
 // operations that can only be done on the same element type
 void elementMallocFromAssignment(ElementTypeID id, void *src, void **result);
 void elementMallocFromUnaryOp(ElementTypeID id, UnaryOpCode opcode, void *src, void **result);
+int32_t integerExponentiation(int32_t base, int32_t exp);  /// INTERFACE - used by unboxed scalar codegen
 // binary operation may not return the same type e.g. 1 == 2
 void elementMallocFromBinOp(ElementTypeID operandID, BinOpCode opcode, void *op1, void *op2, void **result);
 
@@ -70,6 +78,10 @@ void arrayMallocFromUnaryOp(ElementTypeID id, UnaryOpCode opcode, void *src, int
 /// binary op
 bool arrayBinopResultType(ElementTypeID id, BinOpCode opcode, ElementTypeID *resultType, bool* resultCollapseToScalar);
 void arrayMallocFromBinOp(ElementTypeID id, BinOpCode opcode, void *op1, int64_t op1Size, void *op2, int64_t op2Size, void **result, int64_t *resultSize);
+// element-wise arithmetic/comparison on arrays whose element type is known ahead of time; no type checking is done
+// a stride of 0 broadcasts a scalar operand over the other one
+void arrayMallocFromIntegerBinOp(BinOpCode opcode, int32_t *op1, int64_t op1Stride, int32_t *op2, int64_t op2Stride, int64_t size, void **result);
+void arrayMallocFromRealBinOp(BinOpCode opcode, float *op1, int64_t op1Stride, float *op2, int64_t op2Stride, int64_t size, void **result);
 
 /// casting and promotion
 void arrayMallocFromCast(ElementTypeID resultID, ElementTypeID srcID, int64_t size, void *src, void **result);
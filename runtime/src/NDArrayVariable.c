@@ -1,13 +1,15 @@
 #include "NDArray.h"
+#include "ArrayKernels.h"
 #include "RuntimeErrors.h"
 #include "string.h"
 #include "NDArrayVariable.h"
 #include "Literal.h"
 #include "FreeList.h"
 #include "VariableStdio.h"
+#include "SlabAllocator.h"
 
 ArrayType *arrayTypeMalloc() {
-    return malloc(sizeof(ArrayType));
+    return slabMalloc(sizeof(ArrayType));
 }
 
 void arrayTypeInitFromVectorSize(ArrayType *this, ElementTypeID elementTypeID, int64_t vecLength, bool isString) {
@@ -36,20 +38,24 @@ void arrayTypeInitFromDims(ArrayType *this, ElementTypeID elementTypeID, int8_t
         errorAndExit("Attempt to initialize an ndarray to nDim=DIM_INVALID!");
     }
     this->m_isString = isString;
+    this->m_isLiteral = false;
     this->m_elementTypeID = elementTypeID;
     this->m_nDim = nDim;
+    this->m_dims[0] = this->m_dims[1] = 0;
     if (nDim != 0 && nDim != DIM_UNSPECIFIED) {
-        this->m_dims = malloc(nDim * sizeof(int64_t));
         memcpy(this->m_dims, dims, nDim * sizeof(int64_t));
-    } else
-        this->m_dims = NULL;
+    }
+    arrayTypeUpdateCachedSizes(this);
 
     if (refCount != NULL)  {
         this->m_refCount = refCount;
+        this->m_isBorrowed = true;
         arrayTypeIncReferenceCount(this);
     } else {
-        this->m_refCount = malloc(sizeof(int32_t));
-        *this->m_refCount = 1;
+        this->m_refCount = malloc(2 * sizeof(int32_t));
+        this->m_refCount[ARRAY_REF_COUNT_HOLDERS] = 1;
+        this->m_refCount[ARRAY_REF_COUNT_OWNERS] = 1;
+        this->m_isBorrowed = false;
     }
 #ifdef DEBUG_PRINT
     fprintf(stderr, "rc:%p->%d\n", this->m_refCount, *this->m_refCount);
@@ -65,21 +71,38 @@ void arrayTypeDestructor(ArrayType *this) {
     } else {
         arrayTypeDecReferenceCount(this);
     }
-    free(this->m_dims);
 }
 
 // Array type methods
 
 int32_t arrayTypeGetReferenceCount(ArrayType *this) {
-    return *this->m_refCount;
+    return this->m_refCount[ARRAY_REF_COUNT_HOLDERS];
 }
 
 void arrayTypeDecReferenceCount(ArrayType *this) {
-    (*this->m_refCount)--;
+    this->m_refCount[ARRAY_REF_COUNT_HOLDERS]--;
+    if (!this->m_isBorrowed)
+        this->m_refCount[ARRAY_REF_COUNT_OWNERS]--;
 }
 
 void arrayTypeIncReferenceCount(ArrayType *this) {
-    (*this->m_refCount)++;
+    this->m_refCount[ARRAY_REF_COUNT_HOLDERS]++;
+    if (!this->m_isBorrowed)
+        this->m_refCount[ARRAY_REF_COUNT_OWNERS]++;
+}
+
+void arrayTypeShareReferenceCount(ArrayType *this, ArrayType *other) {
+    free(this->m_refCount);
+    this->m_refCount = other->m_refCount;
+    arrayTypeIncReferenceCount(this);
+}
+
+bool arrayTypeIsShared(ArrayType *this) {
+    return this->m_refCount[ARRAY_REF_COUNT_OWNERS] > 1;
+}
+
+bool arrayTypeIsBorrowed(ArrayType *this) {
+    return this->m_refCount[ARRAY_REF_COUNT_HOLDERS] > this->m_refCount[ARRAY_REF_COUNT_OWNERS];
 }
 
 VecToVecRHSSizeRestriction arrayTypeMinimumCompatibleRestriction(ArrayType *this, ArrayType *target) {
@@ -117,19 +140,24 @@ bool arrayTypeHasUnknownSize(ArrayType *this) {
 }
 
 int64_t arrayTypeElementSize(ArrayType *this) {
-    return elementGetSize(this->m_elementTypeID);
+    return this->m_elementSize;
 }
 int64_t arrayTypeGetTotalLength(ArrayType *this) {
+    return this->m_totalLength;
+}
+
+void arrayTypeUpdateCachedSizes(ArrayType *this) {
     int8_t nDim = this->m_nDim;
     if (nDim == DIM_UNSPECIFIED) {
-        return 0;
+        this->m_totalLength = 0;
     } else if (nDim == 0) {
-        return 1;
+        this->m_totalLength = 1;
     } else if (nDim == 1) {
-        return this->m_dims[0];
-    } else if (nDim == 2) {
-        return this->m_dims[0] * this->m_dims[1];
+        this->m_totalLength = this->m_dims[0];
+    } else {
+        this->m_totalLength = this->m_dims[0] * this->m_dims[1];
     }
+    this->m_elementSize = elementGetSize(this->m_elementTypeID);
 }
 
 // Type
@@ -297,6 +325,9 @@ bool typeIsIntegerVector(Type *this) {
 }
 
 bool typeIsArraySameTypeSameSize(Type *this, Type *other) {
+    if (this == other) {
+        return true;
+    }
     ArrayType *CTI = this->m_compoundTypeInfo;
     ArrayType *otherCTI = other->m_compoundTypeInfo;
     bool isEqual = CTI->m_nDim == otherCTI->m_nDim &&
@@ -683,7 +714,7 @@ void variableNDArrayDestructor(Variable *this) {
             }
         } break;
         case NDARRAY_INDEX_REF_NOT_A_REF: {
-            if (arrayTypeGetReferenceCount(CTI) <= 1) {
+            if (arrayTypeGetReferenceCount(CTI) <= 1 && !variableHasInlineData(this)) {
                 arrayFree(CTI->m_elementTypeID, this->m_data, arrayTypeGetTotalLength(CTI));
             }
         } break;
@@ -695,12 +726,19 @@ void variableNDArrayDestructor(Variable *this) {
 
 void variableInitFromNDArrayCopy(Variable *this, Variable *other) {
     NDArrayIndexRefTypeID id = variableGetIndexRefTypeID(other);
-    if(id == NDARRAY_INDEX_REF_NOT_A_REF) {
+    if (variableNDArrayCanShareData(other)) {
+        variableInitFromNDArrayShare(this, other);
+    } else if(id == NDARRAY_INDEX_REF_NOT_A_REF) {
         ArrayType *otherCTI = other->m_type->m_compoundTypeInfo;
         this->m_type = typeMalloc();
         typeInitFromCopy(this->m_type, other->m_type);
-        this->m_data = arrayMallocFromMemcpy(otherCTI->m_elementTypeID, arrayTypeGetTotalLength(otherCTI),
-                                             other->m_data);
+        int64_t length = arrayTypeGetTotalLength(otherCTI);
+        if (elementIsBasicType(otherCTI->m_elementTypeID)) {
+            this->m_data = variableNDArrayMallocData(this, otherCTI->m_elementTypeID, length);
+            memcpy(this->m_data, other->m_data, elementGetSize(otherCTI->m_elementTypeID) * length);
+        } else {
+            this->m_data = arrayMallocFromMemcpy(otherCTI->m_elementTypeID, length, other->m_data);
+        }
         variableAttrInitHelper(this, -1, this->m_data, false);
     } else {
         variableInitFromNDArrayIndexRefToValue(this, other);
@@ -710,8 +748,20 @@ void variableInitFromNDArrayCopy(Variable *this, Variable *other) {
 #endif
 }
 
+// Small arrays of basic elements live in the variable's inline buffer; the rest is allocated as before
+void *variableNDArrayMallocData(Variable *this, ElementTypeID eid, int64_t length) {
+    if (!elementIsBasicType(eid)) {
+        return arrayMallocFromNull(eid, length);
+    }
+    int64_t size = elementGetSize(eid) * length;
+    void *data = variableMallocData(this, size);
+    memset(data, 0, size);
+    return data;
+}
+
 void variableInitFromNDArrayCopyByRef(Variable *this, Variable *other) {
     ArrayType *otherCTI = other->m_type->m_compoundTypeInfo;
+    variableMoveDataOutOfLine(other, elementGetSize(otherCTI->m_elementTypeID) * arrayTypeGetTotalLength(otherCTI));
     this->m_type = typeMalloc();
     this->m_type->m_typeId = other->m_type->m_typeId;
     this->m_type->m_compoundTypeInfo = arrayTypeMalloc();
@@ -723,6 +773,47 @@ void variableInitFromNDArrayCopyByRef(Variable *this, Variable *other) {
 #endif
 }
 
+// Arrays small enough for the inline buffer are cheaper to copy than to share
+bool variableNDArrayCanShareData(Variable *this) {
+    if (this->m_type->m_typeId != TYPEID_NDARRAY)
+        return false;
+    ArrayType *CTI = this->m_type->m_compoundTypeInfo;
+    return !CTI->m_isRef && CTI->m_nDim > 0 && elementIsBasicType(CTI->m_elementTypeID)
+        && !variableHasInlineData(this) && !arrayTypeIsBorrowed(CTI);
+}
+
+void variableInitFromNDArrayShare(Variable *this, Variable *other) {
+    this->m_type = typeMalloc();
+    this->m_type->m_typeId = other->m_type->m_typeId;
+    this->m_type->m_compoundTypeInfo = arrayTypeMalloc();
+    arrayTypeInitFromCopy(this->m_type->m_compoundTypeInfo, other->m_type->m_compoundTypeInfo);
+    arrayTypeShareReferenceCount(this->m_type->m_compoundTypeInfo, other->m_type->m_compoundTypeInfo);
+    this->m_data = other->m_data;
+    variableAttrInitHelper(this, -1, this->m_data, false);
+#ifdef DEBUG_PRINT
+    variableInitDebugPrint(this, "NDArray share");
+#endif
+}
+
+void variableNDArrayMakeUnique(Variable *this) {
+    if (this->m_type->m_typeId != TYPEID_NDARRAY)
+        return;
+    ArrayType *CTI = this->m_type->m_compoundTypeInfo;
+    if (CTI->m_isRef || !arrayTypeIsShared(CTI))
+        return;
+    int64_t size = elementGetSize(CTI->m_elementTypeID) * arrayTypeGetTotalLength(CTI);
+    void *data = malloc(size);
+    memcpy(data, this->m_data, size);
+    arrayTypeDecReferenceCount(CTI);
+    CTI->m_refCount = malloc(2 * sizeof(int32_t));
+    CTI->m_refCount[ARRAY_REF_COUNT_HOLDERS] = 1;
+    CTI->m_refCount[ARRAY_REF_COUNT_OWNERS] = 1;
+    if (this->m_parent == this->m_data) {
+        this->m_parent = data;
+    }
+    this->m_data = data;
+}
+
 Variable *variableNDArrayIndexRefGetRootVariable(Variable *indexRef) {
     while (variableGetIndexRefTypeID(indexRef) != NDARRAY_INDEX_REF_NOT_A_REF) {
         Variable **vars = indexRef->m_data;
@@ -733,12 +824,12 @@ Variable *variableNDArrayIndexRefGetRootVariable(Variable *indexRef) {
 
 void *ndarrayNonRefElementPtrGetter(Variable *this, int64_t pos) {
     ArrayType *CTI = this->m_type->m_compoundTypeInfo;
-    int64_t len = arrayTypeGetTotalLength(CTI);
+    int64_t len = CTI->m_totalLength;
     if (pos < 0 || pos >= len) {
         fprintf(stderr, "Index: %ld Len: %ld\n", pos, len);
         singleTypeError(this->m_type, "Array access out of range with type:");
     }
-    return arrayGetElementPtrAtIndex(CTI->m_elementTypeID, this->m_data, pos);
+    return (char *)this->m_data + CTI->m_elementSize * pos;  // null and identity have size 0, so they yield m_data
 }
 
 void *ndarrayRefElementPtrGetter(Variable *this, int64_t pos) {
@@ -795,6 +886,7 @@ void *variableNDArrayCopyGet(Variable *this, int64_t pos) {
 }
 
 void variableNDArraySet(Variable *this, int64_t pos, void *val) {
+    variableNDArrayMakeUnique(this);
     void *target = variableNDArrayGet(this, pos);
     ArrayType *CTI = this->m_type->m_compoundTypeInfo;
     elementAssign(CTI->m_elementTypeID, target, val);
@@ -821,4 +913,129 @@ NDArrayIndexRefTypeID variableGetIndexRefTypeID(Variable *this) {
             singleTypeError(self->m_type, "Attempt get index ref type id of type:");
         }
     }
-}
\ No newline at end of file
+}
+// true if the variable holds its own contiguous array of the given element type i.e. not a literal or a reference
+bool variableIsConcreteArrayOf(Variable *this, ElementTypeID eid) {
+    if (this->m_type->m_typeId != TYPEID_NDARRAY)
+        return false;
+    ArrayType *CTI = this->m_type->m_compoundTypeInfo;
+    return CTI->m_elementTypeID == eid && !CTI->m_isRef && CTI->m_nDim >= 0;
+}
+
+// entry point for binops whose operand element types were resolved at compile time
+// operands that turn out to be literals, references or of different shapes are left to variableInitFromBinaryOp,
+// which owns the conversion and error rules for them
+void variableInitFromSameElementTypeArrayBinOp(Variable *this, Variable *op1, Variable *op2, BinOpCode opcode, ElementTypeID eid) {
+    if (!variableIsConcreteArrayOf(op1, eid) || !variableIsConcreteArrayOf(op2, eid)) {
+        variableInitFromBinaryOp(this, op1, op2, opcode);
+        return;
+    }
+    ArrayType *op1CTI = op1->m_type->m_compoundTypeInfo;
+    ArrayType *op2CTI = op2->m_type->m_compoundTypeInfo;
+    if (op1CTI->m_nDim != 0 && op2CTI->m_nDim != 0 && !typeIsArraySameTypeSameSize(op1->m_type, op2->m_type)) {
+        variableInitFromBinaryOp(this, op1, op2, opcode);
+        return;
+    }
+
+    ArrayType *shapeCTI = op1CTI->m_nDim >= op2CTI->m_nDim ? op1CTI : op2CTI;
+    int64_t size = arrayTypeGetTotalLength(shapeCTI);
+    int64_t op1Stride = op1CTI->m_nDim == 0 ? 0 : 1;
+    int64_t op2Stride = op2CTI->m_nDim == 0 ? 0 : 1;
+    if (eid == ELEMENT_INTEGER) {
+        arrayMallocFromIntegerBinOp(opcode, op1->m_data, op1Stride, op2->m_data, op2Stride, size, &this->m_data);
+    } else {
+        arrayMallocFromRealBinOp(opcode, op1->m_data, op1Stride, op2->m_data, op2Stride, size, &this->m_data);
+    }
+
+    bool isComparison = opcode == BINARY_LT || opcode == BINARY_BT || opcode == BINARY_LEQ || opcode == BINARY_BEQ;
+    this->m_type = typeMalloc();
+    typeInitFromArrayType(this->m_type, false, isComparison ? ELEMENT_BOOLEAN : eid, shapeCTI->m_nDim, shapeCTI->m_dims);
+    variableAttrInitHelper(this, -1, this->m_data, false);
+#ifdef DEBUG_PRINT
+    variableInitDebugPrint(this, "specialized binop");
+#endif
+}
+
+void variableInitFromIntegerArrayBinOp(Variable *this, Variable *op1, Variable *op2, BinOpCode opcode) {
+    variableInitFromSameElementTypeArrayBinOp(this, op1, op2, opcode, ELEMENT_INTEGER);
+}
+
+void variableInitFromRealArrayBinOp(Variable *this, Variable *op1, Variable *op2, BinOpCode opcode) {
+    variableInitFromSameElementTypeArrayBinOp(this, op1, op2, opcode, ELEMENT_REAL);
+}
+
+// evaluates the program one operation at a time, exactly as the unfused expression would have been
+static void variableInitFromArrayExpressionByOperation(Variable *this, ElementTypeID eid, int32_t *program,
+                                                       int32_t programLength, Variable **operands) {
+    Variable *stack[KERNEL_FUSED_MAX_DEPTH];
+    bool isTemporary[KERNEL_FUSED_MAX_DEPTH];
+    int32_t top = 0;
+    for (int32_t pc = 0; pc < programLength; pc++) {
+        int32_t instruction = program[pc];
+        if (instruction < 0) {
+            stack[top] = operands[-1 - instruction];
+            isTemporary[top] = false;
+            top++;
+            continue;
+        }
+        top--;
+        Variable *result = pc == programLength - 1 ? this : variableMalloc();
+        variableInitFromSameElementTypeArrayBinOp(result, stack[top - 1], stack[top], instruction, eid);
+        if (isTemporary[top - 1])
+            variableDestructThenFree(stack[top - 1]);
+        if (isTemporary[top])
+            variableDestructThenFree(stack[top]);
+        stack[top - 1] = result;
+        isTemporary[top - 1] = true;
+    }
+}
+
+// operands that are literals, references or of different shapes, and elements that raise an error, are left to the
+// operation by operation evaluation, which owns the conversion and error rules for them
+void variableInitFromFusedArrayExpression(Variable *this, ElementTypeID eid, int32_t *program, int32_t programLength,
+                                          Variable **operands, int32_t nOperands) {
+    // the result takes the shape of the array operands, which all have to agree; scalars are broadcast
+    Variable *shapeOperand = NULL;
+    for (int32_t i = 0; i < nOperands; i++) {
+        if (!variableIsConcreteArrayOf(operands[i], eid)) {
+            variableInitFromArrayExpressionByOperation(this, eid, program, programLength, operands);
+            return;
+        }
+        ArrayType *CTI = operands[i]->m_type->m_compoundTypeInfo;
+        if (CTI->m_nDim == 0)
+            continue;
+        if (shapeOperand == NULL) {
+            shapeOperand = operands[i];
+        } else if (!typeIsArraySameTypeSameSize(shapeOperand->m_type, operands[i]->m_type)) {
+            variableInitFromArrayExpressionByOperation(this, eid, program, programLength, operands);
+            return;
+        }
+    }
+    ArrayType *shapeCTI = (shapeOperand == NULL ? operands[0] : shapeOperand)->m_type->m_compoundTypeInfo;
+
+    int64_t size = arrayTypeGetTotalLength(shapeCTI);
+    const void **operandData = malloc(nOperands * sizeof(void *));
+    int64_t *operandStrides = malloc(nOperands * sizeof(int64_t));
+    for (int32_t i = 0; i < nOperands; i++) {
+        ArrayType *CTI = operands[i]->m_type->m_compoundTypeInfo;
+        operandData[i] = operands[i]->m_data;
+        operandStrides[i] = CTI->m_nDim == 0 ? 0 : 1;
+    }
+    void *data = malloc(size * elementGetSize(eid));
+    bool success = kernelFusedExpression(eid, program, programLength, operandData, operandStrides, size, data);
+    free(operandData);
+    free(operandStrides);
+    if (!success) {
+        free(data);
+        variableInitFromArrayExpressionByOperation(this, eid, program, programLength, operands);
+        return;
+    }
+
+    this->m_data = data;
+    this->m_type = typeMalloc();
+    typeInitFromArrayType(this->m_type, false, eid, shapeCTI->m_nDim, shapeCTI->m_dims);
+    variableAttrInitHelper(this, -1, this->m_data, false);
+#ifdef DEBUG_PRINT
+    variableInitDebugPrint(this, "fused expression");
+#endif
+}
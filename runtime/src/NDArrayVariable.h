@@ -36,13 +36,28 @@
 typedef struct struct_gazprea_array_type {
     ElementTypeID m_elementTypeID;  // type of the element
     int8_t m_nDim;                  // # of dimensions
-    int64_t *m_dims;                // each int64_t specify the length of array in one dimension
-    int32_t *m_refCount;              // the number of times m_data is pointed to; determines if we are able to free m_data in destructor
+    int64_t m_dims[2];              // each int64_t specify the length of array in one dimension, only m_nDim are used
+    int64_t m_totalLength;          // cached arrayTypeGetTotalLength(), see arrayTypeUpdateCachedSizes()
+    int64_t m_elementSize;          // cached arrayTypeElementSize()
+    int32_t *m_refCount;              // see ARRAY_REF_COUNT_HOLDERS and ARRAY_REF_COUNT_OWNERS
     bool m_isString;
     bool m_isRef;                     // if the array is index reference, default to false
     bool m_isSelfRef;                 // if the array is indexed by itself E.g. a[a], default to false
+    bool m_isBorrowed;                // if m_data is held on behalf of an index reference rather than owned as a value
+    bool m_isLiteral;                 // if the array is a constant vector/matrix literal, which promotes like a mixed one
 } ArrayType;
 
+/**
+ * m_refCount points to two counters shared by every ArrayType whose variable points to the same m_data
+ * - holders: the number of times m_data is pointed to; determines if we are able to free m_data in destructor
+ * - owners: the holders that own m_data as a value, i.e. not borrowed by an index reference
+ * Copies of a concrete array share m_data and only make their own copy before the first write (copy-on-write).
+ * Owners > 1 means m_data is shared and must be copied before writing to it;
+ * holders > owners means index references to m_data are alive, which will write to it, so it can't be shared
+ */
+#define ARRAY_REF_COUNT_HOLDERS 0
+#define ARRAY_REF_COUNT_OWNERS 1
+
 /// allocate
 ArrayType *arrayTypeMalloc();
 /// constructor
@@ -59,10 +74,14 @@ void arrayTypeDestructor(ArrayType *this);
 int32_t arrayTypeGetReferenceCount(ArrayType *this);
 void arrayTypeDecReferenceCount(ArrayType *this);
 void arrayTypeIncReferenceCount(ArrayType *this);
+void arrayTypeShareReferenceCount(ArrayType *this, ArrayType *other);  // this becomes another owner of other's m_data
+bool arrayTypeIsShared(ArrayType *this);
+bool arrayTypeIsBorrowed(ArrayType *this);
 VecToVecRHSSizeRestriction arrayTypeMinimumCompatibleRestriction(ArrayType *this, ArrayType *target);
 bool arrayTypeHasUnknownSize(ArrayType *this);
 int64_t arrayTypeElementSize(ArrayType *this);
 int64_t arrayTypeGetTotalLength(ArrayType *this);
+void arrayTypeUpdateCachedSizes(ArrayType *this);  // must be called after changing m_dims or m_elementTypeID in place
 
 
 ///------------------------------Type---------------------------------------------------------------
@@ -100,10 +119,25 @@ void variableInitFromMatrixIndexing(Variable *this, Variable *arr, Variable *row
 void variableNDArrayDestructor(Variable *this);  // called in variableFree()
 
 void variableInitFromNDArrayCopy(Variable *this, Variable *other);
+void *variableNDArrayMallocData(Variable *this, ElementTypeID eid, int64_t length);  // zero-initialized element storage
 void variableInitFromNDArrayCopyByRef(Variable *this, Variable *other);
+bool variableNDArrayCanShareData(Variable *this);
+void variableInitFromNDArrayShare(Variable *this, Variable *other);
+// gives this its own copy of m_data if it is shared, must be called before writing to an array
+void variableNDArrayMakeUnique(Variable *this);  /// INTERFACE
 Variable *variableNDArrayIndexRefGetRootVariable(Variable *indexRef);
 
 void *variableNDArrayGet(Variable *this, int64_t pos);
 void *variableNDArrayCopyGet(Variable *this, int64_t pos);
 void variableNDArraySet(Variable *this, int64_t pos, void *val);
-NDArrayIndexRefTypeID variableGetIndexRefTypeID(Variable *this);
\ No newline at end of file
+NDArrayIndexRefTypeID variableGetIndexRefTypeID(Variable *this);
+
+bool variableIsConcreteArrayOf(Variable *this, ElementTypeID eid);
+void variableInitFromSameElementTypeArrayBinOp(Variable *this, Variable *op1, Variable *op2, BinOpCode opcode, ElementTypeID eid);
+// element-wise arithmetic and comparison between integer (or real) scalars/vectors/matrices known at compile time
+void variableInitFromIntegerArrayBinOp(Variable *this, Variable *op1, Variable *op2, BinOpCode opcode);    /// INTERFACE
+void variableInitFromRealArrayBinOp(Variable *this, Variable *op1, Variable *op2, BinOpCode opcode);       /// INTERFACE
+// an element-wise integer (or real) expression tree evaluated in one pass, program is laid out as described for
+// kernelFusedExpression in ArrayKernels.h
+void variableInitFromFusedArrayExpression(Variable *this, ElementTypeID eid, int32_t *program, int32_t programLength,
+                                          Variable **operands, int32_t nOperands);  /// INTERFACE
\ No newline at end of file
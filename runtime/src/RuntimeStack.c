@@ -1,16 +1,16 @@
 #include <malloc.h>
+#include <string.h>
 #include "RuntimeStack.h"
 #include "RuntimeErrors.h"
 #include "VariableStdio.h"
 
 /// helpers
 void runtimeStackResize(RuntimeStack *stack, int64_t newSize) {
-    StackItem *arr = malloc(newSize * sizeof(StackItem));
-    for (int64_t i = 0; i < stack->m_idx; i++) {
-        arr[i] = stack->m_stack[i];
+    StackItem *arr = realloc(stack->m_stack, newSize * sizeof(StackItem));
+    if (arr == NULL) {
+        errorAndExit("Out of memory!");
     }
     stack->m_size = newSize;
-    free(stack->m_stack);
     stack->m_stack = arr;
 }
 void runtimeStackPush(RuntimeStack *stack, StackItem item) {
@@ -21,37 +21,79 @@ void runtimeStackPush(RuntimeStack *stack, StackItem item) {
     stack->m_idx += 1;
 }
 
+RuntimeStackArenaChunk *runtimeStackArenaChunkMalloc(RuntimeStackArenaChunk *prev, int64_t capacity) {
+    RuntimeStackArenaChunk *chunk = malloc(sizeof(RuntimeStackArenaChunk) + capacity);
+    if (chunk == NULL) {
+        errorAndExit("Out of memory!");
+    }
+    chunk->m_prev = prev;
+    chunk->m_next = NULL;
+    chunk->m_used = 0;
+    chunk->m_capacity = capacity;
+    return chunk;
+}
+void *runtimeStackArenaAllocate(RuntimeStack *stack, int64_t size) {
+    size = (size + 15) & ~(int64_t)15;  // keep every object 16-byte aligned
+    RuntimeStackArenaChunk *chunk = stack->m_arena;
+    while (chunk->m_used + size > chunk->m_capacity) {
+        if (chunk->m_next == NULL) {
+            int64_t capacity = size > RUNTIME_STACK_ARENA_CHUNK_SIZE ? size : RUNTIME_STACK_ARENA_CHUNK_SIZE;
+            chunk->m_next = runtimeStackArenaChunkMalloc(chunk, capacity);
+        }
+        chunk = chunk->m_next;
+        chunk->m_used = 0;
+    }
+    stack->m_arena = chunk;
+    void *result = chunk->m_data + chunk->m_used;
+    chunk->m_used += size;
+    return result;
+}
+
 /// interfaces
 RuntimeStack *runtimeStackMallocThenInit() {
     RuntimeStack *stack = malloc(sizeof(RuntimeStack));
-    stack->m_size = 1;
-    stack->m_stack = malloc(sizeof(StackItem));
+    stack->m_size = RUNTIME_STACK_INITIAL_SIZE;
+    stack->m_stack = malloc(RUNTIME_STACK_INITIAL_SIZE * sizeof(StackItem));
     stack->m_idx = 0;
+    stack->m_arena = runtimeStackArenaChunkMalloc(NULL, RUNTIME_STACK_ARENA_CHUNK_SIZE);
     return stack;
 }
 void runtimeStackDestructThenFree(RuntimeStack *stack) {
     runtimeStackRestore(stack, 0);
+    RuntimeStackArenaChunk *chunk = stack->m_arena;
+    while (chunk->m_prev != NULL) {
+        chunk = chunk->m_prev;
+    }
+    while (chunk != NULL) {
+        RuntimeStackArenaChunk *next = chunk->m_next;
+        free(chunk);
+        chunk = next;
+    }
     free(stack->m_stack);
     free(stack);
 }
 
 Variable *variableStackAllocate(RuntimeStack *stack) {
-    Variable *var = variableMalloc();
-    StackItem item = {STACK_ITEM_VARIABLE, var};
+    Variable *var = runtimeStackArenaAllocate(stack, sizeof(Variable));
+    StackItem item = {STACK_ITEM_VARIABLE, var, stack->m_arena};
     runtimeStackPush(stack, item);
     return var;
 }
 Type *typeStackAllocate(RuntimeStack *stack) {
-    Type *type = typeMalloc();
-    StackItem item = {STACK_ITEM_TYPE, type};
+    Type *type = runtimeStackArenaAllocate(stack, sizeof(Type));
+    StackItem item = {STACK_ITEM_TYPE, type, stack->m_arena};
     runtimeStackPush(stack, item);
     return type;
 }
 int64_t runtimeStackSave(RuntimeStack *stack) {
     return stack->m_idx;
 }
+// Destructors only release what the objects own; the objects themselves go away with the arena reset
 void runtimeStackRestore(RuntimeStack *stack, int64_t position) {
     if (position >= 0 && position <= stack->m_idx) {
+        if (position == stack->m_idx) {
+            return;
+        }
         for (int64_t i = stack->m_idx - 1; i >= position; i--) {
             StackItem *item = &stack->m_stack[i];
             switch (item->m_typeid) {
@@ -59,17 +101,23 @@ void runtimeStackRestore(RuntimeStack *stack, int64_t position) {
 #ifdef DEBUG_PRINT
                     fprintf(stderr, "daf#27(stack free)\n");
 #endif
-                    variableDestructThenFreeImpl(item->m_item);
+                    variableDestructor(item->m_item);
                 } break;
                 case STACK_ITEM_TYPE: {
-                    typeDestructThenFree(item->m_item);
+                    Type *type = item->m_item;
+                    if (type->m_compoundTypeInfo != NULL) {
+                        typeDestructor(type);
+                    }
                 } break;
                 default:
                     errorAndExit("This should not happen!");
             }
         }
+        StackItem *first = &stack->m_stack[position];
+        stack->m_arena = first->m_chunk;
+        stack->m_arena->m_used = (char *)first->m_item - first->m_chunk->m_data;
         stack->m_idx = position;
     } else {
         errorAndExit("Attempt to restore stack to a invalid position!");
     }
-}
\ No newline at end of file
+}
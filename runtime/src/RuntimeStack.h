@@ -5,15 +5,32 @@
 #include "Enums.h"
 
 
+#define RUNTIME_STACK_INITIAL_SIZE 64
+#define RUNTIME_STACK_ARENA_CHUNK_SIZE 4096  // bytes
+
+typedef struct struct_runtime_stack_arena_chunk RuntimeStackArenaChunk;
+
+// Block-scoped Variable and Type objects are bump-allocated from a list of chunks; restoring the stack resets the
+// bump pointer to where the first released item was allocated. Chunks past the current one are kept for reuse
+typedef struct struct_runtime_stack_arena_chunk {
+    RuntimeStackArenaChunk *m_prev;
+    RuntimeStackArenaChunk *m_next;
+    int64_t m_used;
+    int64_t m_capacity;
+    char m_data[];
+} RuntimeStackArenaChunk;
+
 typedef struct struct_runtime_stack_item {
     StackItemType m_typeid;
     void *m_item;
+    RuntimeStackArenaChunk *m_chunk;  // chunk m_item was allocated from
 } StackItem;
 
 typedef struct struct_runtime_stack {
     int64_t m_idx;
     int64_t m_size;
     StackItem *m_stack;
+    RuntimeStackArenaChunk *m_arena;  // chunk currently allocated from
 } RuntimeStack;
 
 /// INTERFACE
@@ -37,6 +54,7 @@ void runtimeStackRestore(RuntimeStack *stack, int64_t position);
 
 
 // every scoped variable or type (that is, not temporary variable)'s variableMalloc() or typeMalloc() is replaced with variableStackAllocate(stack)
+// the object itself lives in the stack's arena: never call variableDestructThenFree() or typeDestructThenFree() on it
 
 
 // block statement
@@ -7,11 +7,38 @@
 #include "NDArray.h"
 #include "VariableStdio.h"
 #include "NDArrayVariable.h"
+#include "SlabAllocator.h"
 
 ///------------------------------TYPE AND VARIABLE---------------------------------------------------------------
 
+static int32_t internedRefCount[2] = {1, 1};  // never reaches zero; only here so the ArrayType invariants hold
+static ArrayType internedArrayTypes[] = {
+    [INTERNED_TYPE_BOOLEAN_SCALAR] = {ELEMENT_BOOLEAN, 0, {0, 0}, 1, sizeof(bool), internedRefCount, false, false, false, false},
+    [INTERNED_TYPE_CHARACTER_SCALAR] = {ELEMENT_CHARACTER, 0, {0, 0}, 1, sizeof(int8_t), internedRefCount, false, false, false, false},
+    [INTERNED_TYPE_INTEGER_SCALAR] = {ELEMENT_INTEGER, 0, {0, 0}, 1, sizeof(int32_t), internedRefCount, false, false, false, false},
+    [INTERNED_TYPE_REAL_SCALAR] = {ELEMENT_REAL, 0, {0, 0}, 1, sizeof(float), internedRefCount, false, false, false, false},
+};
+static IntervalType internedIntegerInterval = {INTEGER_BASE_INTERVAL};
+
+Type internedTypes[NUM_INTERNED_TYPES] = {
+    [INTERNED_TYPE_BOOLEAN_SCALAR] = {TYPEID_NDARRAY, &internedArrayTypes[INTERNED_TYPE_BOOLEAN_SCALAR]},
+    [INTERNED_TYPE_CHARACTER_SCALAR] = {TYPEID_NDARRAY, &internedArrayTypes[INTERNED_TYPE_CHARACTER_SCALAR]},
+    [INTERNED_TYPE_INTEGER_SCALAR] = {TYPEID_NDARRAY, &internedArrayTypes[INTERNED_TYPE_INTEGER_SCALAR]},
+    [INTERNED_TYPE_REAL_SCALAR] = {TYPEID_NDARRAY, &internedArrayTypes[INTERNED_TYPE_REAL_SCALAR]},
+    [INTERNED_TYPE_INTEGER_INTERVAL] = {TYPEID_INTERVAL, &internedIntegerInterval},
+    [INTERNED_TYPE_UNKNOWN] = {TYPEID_UNKNOWN, NULL},
+};
+
+Type *typeGetInterned(InternedTypeID id) {
+    return &internedTypes[id];
+}
+
+bool typeIsInterned(Type *this) {
+    return this >= internedTypes && this < internedTypes + NUM_INTERNED_TYPES;
+}
+
 Type *typeMalloc() {
-    Type *type = malloc(sizeof(Type));
+    Type *type = slabMalloc(sizeof(Type));
 #ifdef DEBUG_PRINT
     if (!reentry)
         fprintf(stderr, "(malloc type %p)\n", (void *)type);
@@ -66,6 +93,9 @@ void typeInitFromIntervalType(Type *this, IntervalTypeBaseTypeID id) {
 }
 
 void typeDestructor(Type *this) {
+    if (typeIsInterned(this)) {
+        return;
+    }
 #ifdef DEBUG_PRINT
     if (!reentry) {
         fprintf(stderr, "(destruct type %p)", (void *) this);
@@ -76,15 +106,15 @@ void typeDestructor(Type *this) {
     switch (this->m_typeId) {
         case TYPEID_NDARRAY:
             arrayTypeDestructor(this->m_compoundTypeInfo);
-            free(this->m_compoundTypeInfo);
+            slabFree(this->m_compoundTypeInfo, sizeof(ArrayType));
             break;
         case TYPEID_TUPLE: {
             TupleType *tupleType = this->m_compoundTypeInfo;
             tupleTypeDestructor(tupleType);
-            free(tupleType);
+            slabFree(tupleType, sizeof(TupleType));
         }    break;  // m_data is ignored for these types
         case TYPEID_INTERVAL: {
-            free(this->m_compoundTypeInfo);
+            slabFree(this->m_compoundTypeInfo, sizeof(IntervalType));
         }
         case TYPEID_STREAM_IN:
         case TYPEID_STREAM_OUT:
@@ -98,12 +128,15 @@ void typeDestructor(Type *this) {
 }
 
 void typeDestructThenFree(Type *this) {
+    if (typeIsInterned(this)) {
+        return;
+    }
     typeDestructor(this);
 #ifdef DEBUG_PRINT
     if (!reentry)
         fprintf(stderr, "(free type %p)\n", (void *)this);
 #endif
-    free(this);
+    slabFree(this, sizeof(Type));
 }
 
 // Type Methods
@@ -148,7 +181,34 @@ bool typeIsUnspecifiedInterval(Type *this) {
 }
 
 bool typeIsIdentical(Type *this, Type *other) {
-    // TODO: implement this (if this is ever needed)
+    if (this == other) {
+        return true;
+    }
+    if (this->m_typeId != other->m_typeId) {
+        return false;
+    }
+    switch (this->m_typeId) {
+        case TYPEID_NDARRAY:
+            return typeIsArraySameTypeSameSize(this, other);
+        case TYPEID_INTERVAL: {
+            IntervalType *CTI = this->m_compoundTypeInfo;
+            IntervalType *otherCTI = other->m_compoundTypeInfo;
+            return CTI->m_baseTypeID == otherCTI->m_baseTypeID;
+        }
+        case TYPEID_TUPLE: {
+            TupleType *CTI = this->m_compoundTypeInfo;
+            TupleType *otherCTI = other->m_compoundTypeInfo;
+            if (CTI->m_nField != otherCTI->m_nField)
+                return false;
+            for (int64_t i = 0; i < CTI->m_nField; i++) {
+                if (!typeIsIdentical(&CTI->m_fieldTypeArr[i], &otherCTI->m_fieldTypeArr[i]))
+                    return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
 }
 
 bool typeIsDomainExprCompatible(Type *this) {
@@ -159,7 +219,7 @@ bool typeIsDomainExprCompatible(Type *this) {
 // IntervalType---------------------------------------------------------------------------------------------
 
 IntervalType *intervalTypeMalloc() {
-    return malloc(sizeof(IntervalType));
+    return slabMalloc(sizeof(IntervalType));
 }
 void *intervalTypeInitFromBase(IntervalType *this, IntervalTypeBaseTypeID id) {
     this->m_baseTypeID = id;
@@ -168,34 +228,27 @@ void *intervalTypeInitFromCopy(IntervalType *this, IntervalType *other) {
     this->m_baseTypeID = other->m_baseTypeID;
 }
 
-void *intervalTypeMallocDataFromNull() {
-    int32_t *interval = malloc(sizeof(int32_t) * 2);
+void intervalTypeInitDataFromNull(int32_t *interval) {
     interval[0] = 0;
     interval[1] = 0;
-    return interval;
 }
 
-void *intervalTypeMallocDataFromIdentity() {
-    int32_t *interval = malloc(sizeof(int32_t) * 2);
+void intervalTypeInitDataFromIdentity(int32_t *interval) {
     interval[0] = 1;
     interval[1] = 1;
-    return interval;
 }
 
-void *intervalTypeMallocDataFromHeadTail(int32_t head, int32_t tail) {
-    int32_t *interval = malloc(sizeof(int32_t) * 2);
+void intervalTypeInitDataFromHeadTail(int32_t *interval, int32_t head, int32_t tail) {
     if (head > tail) {
         errorAndExit("Interval head is greater than tail!");
     }
     interval[0] = head;
     interval[1] = tail;
-    return interval;
 }
 
-void *intervalTypeMallocDataFromCopy(void *otherIntervalData) {
-    int32_t *interval = malloc(sizeof(int32_t) * 2);
-    memcpy(interval, otherIntervalData, sizeof(int32_t) * 2);
-    return interval;
+void intervalTypeInitDataFromCopy(int32_t *interval, const int32_t *otherInterval) {
+    interval[0] = otherInterval[0];
+    interval[1] = otherInterval[1];
 }
 
 void intervalTypeFreeData(void *data) {
@@ -259,7 +312,7 @@ void intervalTypeBinaryNe(bool *result, const int32_t *op1, const int32_t *op2)
 // TupleType---------------------------------------------------------------------------------------------
 
 TupleType *tupleTypeMalloc() {
-    return malloc(sizeof(TupleType));
+    return slabMalloc(sizeof(TupleType));
 }
 
 void tupleTypeInitFromTypeAndId(TupleType *this, int64_t nField, Type **typeArray, int64_t *stridArray) {
@@ -26,6 +26,12 @@ void typeInitFromIntervalType(Type *this, IntervalTypeBaseTypeID id);
 void typeDestructor(Type *this);                     /// INTERFACE
 void typeDestructThenFree(Type *this);               /// INTERFACE
 
+// Types that do not depend on a runtime size are never built at runtime: generated code points at the element of
+// internedTypes for its InternedTypeID. Interned types are immutable and destructing them is a no-op
+extern Type internedTypes[NUM_INTERNED_TYPES];       /// INTERFACE
+Type *typeGetInterned(InternedTypeID id);
+bool typeIsInterned(Type *this);
+
 /// INTERFACE
 bool typeIsVariableClassCompatible(Type *this);  // if the type does not have any unknown/unspecified part i.e. a variable can have this type
 bool typeIsStream(Type *this);
@@ -45,10 +51,13 @@ IntervalType *intervalTypeMalloc();
 void *intervalTypeInitFromBase(IntervalType *this, IntervalTypeBaseTypeID id);
 void *intervalTypeInitFromCopy(IntervalType *this, IntervalType *other);
 
-void *intervalTypeMallocDataFromNull();
-void *intervalTypeMallocDataFromIdentity();
-void *intervalTypeMallocDataFromHeadTail(int32_t head, int32_t tail);
-void *intervalTypeMallocDataFromCopy(void *otherIntervalData);
+#define INTERVAL_DATA_SIZE (2 * sizeof(int32_t))  // head and tail
+
+// interval data is stored in a buffer of INTERVAL_DATA_SIZE bytes, usually the variable's inline buffer
+void intervalTypeInitDataFromNull(int32_t *interval);
+void intervalTypeInitDataFromIdentity(int32_t *interval);
+void intervalTypeInitDataFromHeadTail(int32_t *interval, int32_t head, int32_t tail);
+void intervalTypeInitDataFromCopy(int32_t *interval, const int32_t *otherInterval);
 void intervalTypeFreeData(void *data);
 
 bool intervalTypeIsUnspecified(IntervalType *this);  // if the base type is unspecified, otherwise the base type is integer
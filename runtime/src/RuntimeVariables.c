@@ -7,6 +7,7 @@
 #include "Literal.h"
 #include "VariableStdio.h"
 #include "NDArrayVariable.h"
+#include "SlabAllocator.h"
 
 ///------------------------------DATA---------------------------------------------------------------
 // below explains how m_data is interpreted in each type of data
@@ -272,13 +273,15 @@ void variableInitFromPCADP(Variable *this, Type *targetType, Variable *rhs, PCAD
                 }
                 CTI->m_dims[i] = dim >= 0 ? dim : 0;
             }
+            arrayTypeUpdateCachedSizes(CTI);
             this->m_data = arrayMallocFromNull(CTI->m_elementTypeID, arrayTypeGetTotalLength(CTI));
         } else {  // non-empty array -> array
             int8_t nDim = CTI->m_nDim;
             int64_t *dims = CTI->m_dims;
             // TODO: check if this satisfies spec
             if (!config->m_allowArrToArrDifferentElementTypeConversion && rhsNDim != 0 &&
-                CTI->m_elementTypeID != rhsCTI->m_elementTypeID && rhsCTI->m_elementTypeID != ELEMENT_MIXED) {
+                CTI->m_elementTypeID != rhsCTI->m_elementTypeID && rhsCTI->m_elementTypeID != ELEMENT_MIXED &&
+                !rhsCTI->m_isLiteral) {
                 errorAndExit("No vector/matrix to vector/matrix different element type conversion allowed");
             } else if (nDim < rhsNDim) {
                 errorAndExit("Cannot convert to a lower dimension array!");
@@ -286,6 +289,25 @@ void variableInitFromPCADP(Variable *this, Type *targetType, Variable *rhs, PCAD
                 errorAndExit("Cannot convert from vector to matrix!");
             }
 
+            bool isSameShape = rhsNDim == nDim && CTI->m_elementTypeID == rhsCTI->m_elementTypeID;
+            for (int64_t i = 0; isSameShape && i < nDim; i++) {
+                isSameShape = dims[i] < 0 || dims[i] == rhsDims[i];
+            }
+            if (isSameShape && variableNDArrayCanShareData(rhs)) {
+                // nothing to convert or resize, the result shares rhs's data until either of them is written to
+                for (int64_t i = 0; i < nDim; i++) {
+                    dims[i] = rhsDims[i];
+                }
+                arrayTypeUpdateCachedSizes(CTI);
+                arrayTypeShareReferenceCount(CTI, rhsCTI);
+                this->m_data = rhs->m_data;
+                variableAttrInitHelper(this, -1, this->m_data, config->m_resultIsBlockScoped);
+#ifdef DEBUG_PRINT
+                variableInitDebugPrint(this, "array -> array share");
+#endif
+                return;
+            }
+
             void (*conversion)(ElementTypeID, ElementTypeID, int64_t, void *, void **)
             = config->m_isCast ? arrayMallocFromCast : arrayMallocFromPromote;
             void *convertedArray;
@@ -302,6 +324,7 @@ void variableInitFromPCADP(Variable *this, Type *targetType, Variable *rhs, PCAD
                     if (dims[i] < 0)
                         dims[i] = rhsDims[i];
                 }
+                arrayTypeUpdateCachedSizes(CTI);
                 if (config->m_rhsSizeRestriction < arrayTypeMinimumCompatibleRestriction(rhsCTI, CTI)) {
                     fprintf(stderr, "TargetType:");
                     typeDebugPrint(targetType);
@@ -329,7 +352,7 @@ void variableInitFromPCADP(Variable *this, Type *targetType, Variable *rhs, PCAD
 }
 
 Variable *variableMalloc() {
-    Variable *var = malloc(sizeof(Variable));
+    Variable *var = slabMalloc(sizeof(Variable));
 #ifdef DEBUG_PRINT
     if (!reentry)
         fprintf(stderr, "(malloc var %p)\n", (void *)var);
@@ -337,6 +360,29 @@ Variable *variableMalloc() {
     return var;
 }
 
+void *variableMallocData(Variable *this, int64_t size) {
+    if (size <= VARIABLE_INLINE_DATA_SIZE) {
+        return this->m_inlineData;
+    }
+    return malloc(size);
+}
+
+bool variableHasInlineData(Variable *this) {
+    return this->m_data == (void *)this->m_inlineData;
+}
+
+void variableMoveDataOutOfLine(Variable *this, int64_t size) {
+    if (!variableHasInlineData(this)) {
+        return;
+    }
+    void *data = malloc(size > 0 ? size : 1);
+    memcpy(data, this->m_inlineData, size);
+    if (this->m_parent == this->m_data) {
+        this->m_parent = data;
+    }
+    this->m_data = data;
+}
+
 void variableInitFromMemcpy(Variable *this, Variable *other) {
     if (other->m_type->m_typeId == TYPEID_NDARRAY) {
         variableInitFromNDArrayCopy(this, other);
@@ -355,7 +401,8 @@ void variableInitFromMemcpy(Variable *this, Variable *other) {
         case TYPEID_STREAM_OUT:
             break;  // m_data is ignored for these types
         case TYPEID_INTERVAL: {
-            this->m_data = intervalTypeMallocDataFromCopy(other->m_data);
+            this->m_data = variableMallocData(this, INTERVAL_DATA_SIZE);
+            intervalTypeInitDataFromCopy(this->m_data, other->m_data);
         } break;
         case TYPEID_UNKNOWN:
         case NUM_TYPE_IDS:
@@ -373,6 +420,45 @@ void variableInitFromIdentifier(Variable *this, Variable *other) {
     variableInitFromMemcpy(this, other);
 }
 
+void variableInitFromMove(Variable *this, Variable *other) {
+    if (variableGetIndexRefTypeID(other) != NDARRAY_INDEX_REF_NOT_A_REF) {
+        // an index reference does not own the data it points to
+        variableInitFromNDArrayIndexRefToValue(this, other);
+        variableDestructThenFreeImpl(other);
+        return;
+    }
+    this->m_type = other->m_type;
+    if (this->m_type->m_typeId == TYPEID_NDARRAY) {
+        // once stored in a variable, a literal no longer promotes to other element types
+        ((ArrayType *)this->m_type->m_compoundTypeInfo)->m_isLiteral = false;
+    }
+    if (variableHasInlineData(other)) {
+        memcpy(this->m_inlineData, other->m_inlineData, VARIABLE_INLINE_DATA_SIZE);
+        this->m_data = this->m_inlineData;
+    } else {
+        this->m_data = other->m_data;
+    }
+    variableAttrInitHelper(this, -1, this->m_data, false);
+    slabFree(other, sizeof(Variable));
+#ifdef DEBUG_PRINT
+    variableInitDebugPrint(this, "move");
+#endif
+}
+
+// Tuples are left to PCADP even when identical, since the target type carries the field names
+bool variableCanMoveInto(Variable *this, Type *targetType) {
+    Type *type = this->m_type;
+    if (variableGetIndexRefTypeID(this) != NDARRAY_INDEX_REF_NOT_A_REF || !typeIsVariableClassCompatible(type))
+        return false;
+    if (typeIsUnknown(targetType)) {
+        if (typeIsStream(type))
+            return false;
+        return !typeIsArrayOrString(type) ||
+            !(typeIsMixedArray(type) || typeIsArrayNull(type) || typeIsArrayIdentity(type));
+    }
+    return type->m_typeId != TYPEID_TUPLE && typeIsIdentical(targetType, type);
+}
+
 // <type> var = null;
 void variableInitFromNull(Variable *this, Type *type) {
     this->m_type = typeMalloc();
@@ -393,7 +479,8 @@ void variableInitFromNull(Variable *this, Type *type) {
             IntervalType *CTI = type->m_compoundTypeInfo;
             if (intervalTypeIsUnspecified(CTI))
                 singleTypeError(type, "Attempt to promote null into unknown type: ");
-            this->m_data = intervalTypeMallocDataFromNull();
+            this->m_data = variableMallocData(this, INTERVAL_DATA_SIZE);
+            intervalTypeInitDataFromNull(this->m_data);
         } break;
         case TYPEID_TUPLE: {
             this->m_data = tupleTypeMallocDataFromNull(type->m_compoundTypeInfo);
@@ -428,7 +515,8 @@ void variableInitFromIdentity(Variable *this, Type *type) {
             IntervalType *CTI = type->m_compoundTypeInfo;
             if (intervalTypeIsUnspecified(CTI))
                 singleTypeError(type, "Attempt to promote null into unknown type: ");
-            this->m_data = intervalTypeMallocDataFromIdentity();
+            this->m_data = variableMallocData(this, INTERVAL_DATA_SIZE);
+            intervalTypeInitDataFromIdentity(this->m_data);
         } break;
         case TYPEID_TUPLE: {
             this->m_data = tupleTypeMallocDataFromIdentity(type->m_compoundTypeInfo);
@@ -471,7 +559,8 @@ void variableInitFromUnaryOp(Variable *this, Variable *operand, UnaryOpCode opco
 
     if (operandType->m_typeId == TYPEID_INTERVAL) {
         // +ivl or -ivl
-        int32_t *interval = intervalTypeMallocDataFromNull();
+        int32_t *interval = variableMallocData(this, INTERVAL_DATA_SIZE);
+        intervalTypeInitDataFromNull(interval);
         if (opcode == UNARY_MINUS) {
             intervalTypeUnaryMinus(interval, operand->m_data);
         } else if (opcode == UNARY_PLUS) {
@@ -530,10 +619,11 @@ void computeIvlIvlBinop(Variable *this, Variable *op1, Variable *op2, BinOpCode
     if (opcode == BINARY_EQ || opcode == BINARY_NE) {
         // result is boolean
         typeInitFromArrayType(this->m_type, false, ELEMENT_BOOLEAN, 0, NULL);
-        this->m_data = arrayMallocFromNull(ELEMENT_BOOLEAN, 1);
+        this->m_data = variableNDArrayMallocData(this, ELEMENT_BOOLEAN, 1);
     } else {
         typeInitFromIntervalType(this->m_type, INTEGER_BASE_INTERVAL);
-        this->m_data = intervalTypeMallocDataFromNull();
+        this->m_data = variableMallocData(this, INTERVAL_DATA_SIZE);
+        intervalTypeInitDataFromNull(this->m_data);
     }
     switch(opcode) {
         case BINARY_MULTIPLY:
@@ -627,6 +717,7 @@ void variableInitFromBinaryOpWithSpecTypes(Variable *this, Variable *op1, Variab
                 if (!elementCanBePromotedBetween(ELEMENT_INTEGER, CTI->m_elementTypeID, &CTI->m_elementTypeID)) {
                     errorAndExit("Cannot promote between interval and vector!");
                 }
+                arrayTypeUpdateCachedSizes(CTI);
                 binopPromoteComputationAndDispose(this, op1, op2, opcode, targetType, targetType,
                                                   computeSameTypeSameSizeArrayArrayBinop);
                 typeDestructThenFree(targetType);
@@ -651,6 +742,7 @@ void variableInitFromBinaryOpWithSpecTypes(Variable *this, Variable *op1, Variab
                     typeInitFromCopy(targetType1, op1Type);
                     ArrayType *target1CTI = targetType1->m_compoundTypeInfo;
                     target1CTI->m_elementTypeID = resultEID;
+                    arrayTypeUpdateCachedSizes(target1CTI);
                     Variable *target1 = variableMalloc();
                     variableInitFromPromotion(target1, targetType1, op1);
                     typeDestructThenFree(targetType1);
@@ -659,6 +751,7 @@ void variableInitFromBinaryOpWithSpecTypes(Variable *this, Variable *op1, Variab
                     typeInitFromCopy(targetType2, op2Type);
                     ArrayType *target2CTI = targetType2->m_compoundTypeInfo;
                     target2CTI->m_elementTypeID = resultEID;
+                    arrayTypeUpdateCachedSizes(target2CTI);
                     Variable *target2 = variableMalloc();
                     variableInitFromPromotion(target2, targetType2, op2);
                     typeDestructThenFree(targetType2);
@@ -689,6 +782,7 @@ void variableInitFromBinaryOpWithSpecTypes(Variable *this, Variable *op1, Variab
                                                      &CTI->m_elementTypeID)) {
                         errorAndExit("Cannot promote between vectors!");
                     }
+                    arrayTypeUpdateCachedSizes(CTI);
                     binopPromoteComputationAndDispose(this, op1, op2, opcode, targetType, targetType,
                                                       computeSameTypeSameSizeArrayArrayBinop);
                     typeDestructThenFree(targetType);
@@ -878,6 +972,15 @@ void variableInitFromAssign(Variable *this, Type *lhsType, Variable *rhs) {
 void variableInitFromDeclaration(Variable *this, Type *lhsType, Variable *rhs) {
     variableInitFromPCADP(this, lhsType, rhs, &pcadpDeclarationConfig);
 }
+void variableInitFromDeclarationMove(Variable *this, Type *lhsType, Variable *rhs) {
+    if (variableCanMoveInto(rhs, lhsType)) {
+        variableInitFromMove(this, rhs);
+        variableSetIsBlockScoped(this, pcadpDeclarationConfig.m_resultIsBlockScoped);
+        return;
+    }
+    variableInitFromDeclaration(this, lhsType, rhs);
+    variableDestructThenFreeImpl(rhs);
+}
 void variableInitFromPromotion(Variable *this, Type *lhsType, Variable *rhs) {
     variableInitFromPCADP(this, lhsType, rhs, &pcadpPromotionConfig);
 }
@@ -953,6 +1056,7 @@ void variableInitFromMixedArrayPromoteToSameType(Variable *this, Variable *mixed
                                                   &CTI->m_elementTypeID)) {
         singleTypeError(rhsType, "Attempt to convert to homogenous array from:");
     }
+    arrayTypeUpdateCachedSizes(CTI);
     arrayMallocFromPromote(CTI->m_elementTypeID, ELEMENT_MIXED, size, mixed->m_data, &this->m_data);
     variableAttrInitHelper(this, -1, this->m_data, false);
 #ifdef DEBUG_PRINT
@@ -963,7 +1067,8 @@ void variableInitFromMixedArrayPromoteToSameType(Variable *this, Variable *mixed
 void variableInitFromIntervalHeadTail(Variable *this, Variable *head, Variable *tail) {
     this->m_type = typeMalloc();
     typeInitFromIntervalType(this->m_type, INTEGER_BASE_INTERVAL);
-    this->m_data = intervalTypeMallocDataFromHeadTail(variableGetIntegerValue(head), variableGetIntegerValue(tail));
+    this->m_data = variableMallocData(this, INTERVAL_DATA_SIZE);
+    intervalTypeInitDataFromHeadTail(this->m_data, variableGetIntegerValue(head), variableGetIntegerValue(tail));
     variableAttrInitHelper(this, -1, this->m_data, false);
 #ifdef DEBUG_PRINT
     variableInitDebugPrint(this, "interval head tail");
@@ -996,15 +1101,17 @@ void variableInitFromNDArray(Variable *this, bool isString, ElementTypeID eid, i
     int64_t totalLength = arrayTypeGetTotalLength(this->m_type->m_compoundTypeInfo);
     int64_t elementSize = elementGetSize(eid);
 
-    if (value != NULL) {
-        if (valueIsScalar) {
-            this->m_data = arrayMallocFromElementValue(eid, totalLength, value);
-        } else {
-            this->m_data = arrayMallocFromNull(eid, totalLength);
+    if (value != NULL && valueIsScalar && !elementIsBasicType(eid)) {
+        this->m_data = arrayMallocFromElementValue(eid, totalLength, value);
+    } else {
+        this->m_data = variableNDArrayMallocData(this, eid, totalLength);
+        if (value != NULL && valueIsScalar) {
+            for (int64_t i = 0; i < totalLength; i++) {
+                memcpy((char *)this->m_data + i * elementSize, value, elementSize);
+            }
+        } else if (value != NULL) {
             memcpy(this->m_data, value, elementSize * totalLength);
         }
-    } else {
-        this->m_data = arrayMallocFromNull(eid, totalLength);
     }
     variableAttrInitHelper(this, -1, this->m_data, false);
 #ifdef DEBUG_PRINT
@@ -1053,7 +1160,9 @@ void variableDestructor(Variable *this) {
         case TYPEID_TUPLE:
             break;  // m_data is ignored for these types
         case TYPEID_INTERVAL:
-            intervalTypeFreeData(this->m_data);
+            if (!variableHasInlineData(this)) {
+                intervalTypeFreeData(this->m_data);
+            }
             break;
         case TYPEID_UNKNOWN:
         case NUM_TYPE_IDS:
@@ -1071,7 +1180,7 @@ void variableDestructThenFree(Variable *this) {
     if (!reentry)
         fprintf(stderr, "(llvm side free var %p)\n", (void *)this);
 #endif
-    free(this);
+    slabFree(this, sizeof(Variable));
 }
 
 void variableDestructThenFreeImpl(Variable *this) {
@@ -1080,7 +1189,7 @@ void variableDestructThenFreeImpl(Variable *this) {
     if (!reentry)
         fprintf(stderr, "(free var %p)\n", (void *)this);
 #endif
-    free(this);
+    slabFree(this, sizeof(Variable));
 }
 
 bool variableIsIntegerInterval(Variable *this) { return typeIsIntegerInterval(this->m_type); }
@@ -1202,6 +1311,17 @@ bool variableGetBooleanValue(Variable *this) {
     return result;
 }
 
+float variableGetRealValue(Variable *this) {
+    Type *realTy = typeMalloc();
+    typeInitFromArrayType(realTy, false, ELEMENT_REAL, 0, NULL);
+    Variable *realVar = variableMalloc();
+    variableInitFromPromotion(realVar, realTy, this);
+    float result = *(float *)realVar->m_data;
+    variableDestructThenFreeImpl(realVar);
+    typeDestructThenFree(realTy);
+    return result;
+}
+
 int64_t variableGetNumFieldInTuple(Variable *this) {
     if (this->m_type->m_typeId != TYPEID_TUPLE) {
         singleTypeError(this->m_type, "The given type is not a tuple: ");
@@ -1280,6 +1400,17 @@ void variableAssignment(Variable *this, Variable *rhs) {
     variableDestructThenFreeImpl(result);
 }
 
+void variableAssignMove(Variable *this, Variable *rhs) {
+    if (variableGetIndexRefTypeID(this) == NDARRAY_INDEX_REF_NOT_A_REF && variableCanMoveInto(rhs, this->m_type)) {
+        variableDestructor(this);
+        variableInitFromMove(this, rhs);
+        variableSetIsBlockScoped(this, true);
+        return;
+    }
+    variableAssignment(this, rhs);
+    variableDestructThenFreeImpl(rhs);
+}
+
 void variableReplace(Variable *this, Variable *rhs) {
     variableDestructor(this);
     variableInitFromMemcpy(this, rhs);
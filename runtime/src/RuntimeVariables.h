@@ -5,6 +5,8 @@
 
 ///------------------------------VARIABLE---------------------------------------------------------------
 
+#define VARIABLE_INLINE_DATA_SIZE 16  // bytes
+
 typedef struct struct_gazprea_variable {
     Type *m_type;
     void *m_data;  // stores the value of the variable
@@ -12,9 +14,15 @@ typedef struct struct_gazprea_variable {
     int64_t m_fieldPos;  // used to avoid tuple field aliasing
     void *m_parent;  // used to avoid memory location aliasing in case of vector, matrix and tuple
     bool m_isBlockScoped;
+
+    // small payloads (scalars, intervals, short strings) are stored here and m_data points to it
+    int64_t m_inlineData[VARIABLE_INLINE_DATA_SIZE / sizeof(int64_t)];
 } Variable;
 
 Variable *variableMalloc();
+void *variableMallocData(Variable *this, int64_t size);  // returns the inline buffer if size fits, malloc otherwise
+bool variableHasInlineData(Variable *this);
+void variableMoveDataOutOfLine(Variable *this, int64_t size);  // data shared by reference must not live inside this
 
 typedef enum enum_vectovec_rhssize_restriction {
     vectovec_rhs_must_be_same_size,
@@ -45,6 +53,9 @@ extern PCADPConfig pcadpDomainExpressionConfig;
 void variableInitFromPCADP(Variable *this, Type *targetType, Variable *rhs, PCADPConfig *config);
 void variableInitFromMemcpy(Variable *this, Variable *other);
 void variableInitFromIdentifier(Variable *this, Variable *other);                                 /// INTERFACE
+// the *Move variants consume their source: a temporary from variableMalloc() that is freed by the call
+void variableInitFromMove(Variable *this, Variable *other);                                       /// INTERFACE
+bool variableCanMoveInto(Variable *this, Type *targetType);  // if PCADP into targetType would just copy this
 void variableInitFromNull(Variable *this, Type *type);
 void variableInitFromIdentity(Variable *this, Type *type);
 void variableInitFromUnaryOp(Variable *this, Variable *operand, UnaryOpCode opcode);              /// INTERFACE
@@ -53,6 +64,7 @@ void variableInitFromBinaryOp(Variable *this, Variable *op1, Variable *op2, BinO
 void variableInitFromParameter(Variable *this, Type *lhsType, Variable *rhs);                     /// INTERFACE
 void variableInitFromCast(Variable *this, Type *lhsType, Variable *rhs);                          /// INTERFACE
 void variableInitFromDeclaration(Variable *this, Type *lhsType, Variable *rhs);                   /// INTERFACE
+void variableInitFromDeclarationMove(Variable *this, Type *lhsType, Variable *rhs);               /// INTERFACE
 void variableInitFromAssign(Variable *this, Type *lhsType, Variable *rhs);
 void variableInitFromPromotion(Variable *this, Type *lhsType, Variable *rhs);                     /// INTERFACE
 void variableInitFromDomainExpression(Variable *this, Variable *rhs);                             /// INTERFACE
@@ -87,9 +99,11 @@ void variableAttrInitHelper(Variable *this, int64_t fieldPos, void *m_parent, bo
 // promote to integer scalar and return the value as int32_t
 int32_t variableGetIntegerValue(Variable *this);                                                  /// INTERFACE
 bool variableGetBooleanValue(Variable *this);                                                     /// INTERFACE
+float variableGetRealValue(Variable *this);                                                       /// INTERFACE
 Variable *variableGetTupleField(Variable *tuple, int64_t pos);                                    /// INTERFACE
 Variable *variableGetTupleFieldFromID(Variable *tuple, int64_t id);                               /// INTERFACE
 int64_t variableGetNumFieldInTuple(Variable *this);                                               /// INTERFACE
 bool variableAliasWith(Variable *this, Variable *other);                                          /// INTERFACE return ture if the two variable alias
 void variableAssignment(Variable *this, Variable *rhs);                                           /// INTERFACE
+void variableAssignMove(Variable *this, Variable *rhs);                                           /// INTERFACE
 void variableReplace(Variable *this, Variable *rhs);                                              /// INTERFACE
\ No newline at end of file
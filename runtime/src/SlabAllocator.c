@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include "SlabAllocator.h"
+#include "RuntimeErrors.h"
+
+typedef struct struct_slab_free_object SlabFreeObject;
+
+typedef struct struct_slab_free_object {
+    SlabFreeObject *m_next;
+} SlabFreeObject;
+
+typedef struct struct_slab_statistics {
+    int64_t m_nAllocation;
+    int64_t m_nFree;
+    int64_t m_nChunk;
+} SlabStatistics;
+
+static _Thread_local SlabFreeObject *freeLists[SLAB_NUM_SIZE_CLASSES];
+static _Thread_local SlabStatistics statistics;
+
+/// helpers
+static int64_t slabSizeClassOf(size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    return (int64_t)((size + SLAB_GRANULE - 1) / SLAB_GRANULE) - 1;
+}
+
+// chunks are never given back to malloc; freed objects stay on the free list of the thread that freed them
+static void slabRefill(int64_t sizeClass) {
+    size_t objectSize = (size_t)(sizeClass + 1) * SLAB_GRANULE;
+    char *chunk = malloc(objectSize * SLAB_OBJECTS_PER_CHUNK);
+    if (chunk == NULL) {
+        errorAndExit("Out of memory!");
+    }
+    for (int64_t i = SLAB_OBJECTS_PER_CHUNK - 1; i >= 0; i--) {
+        SlabFreeObject *object = (SlabFreeObject *)(chunk + i * objectSize);
+        object->m_next = freeLists[sizeClass];
+        freeLists[sizeClass] = object;
+    }
+    statistics.m_nChunk++;
+}
+
+/// interfaces
+void *slabMalloc(size_t size) {
+    int64_t sizeClass = slabSizeClassOf(size);
+    if (sizeClass >= SLAB_NUM_SIZE_CLASSES) {
+        return malloc(size);
+    }
+    if (freeLists[sizeClass] == NULL) {
+        slabRefill(sizeClass);
+    }
+    SlabFreeObject *object = freeLists[sizeClass];
+    freeLists[sizeClass] = object->m_next;
+    statistics.m_nAllocation++;
+    return object;
+}
+
+void slabFree(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+    int64_t sizeClass = slabSizeClassOf(size);
+    if (sizeClass >= SLAB_NUM_SIZE_CLASSES) {
+        free(ptr);
+        return;
+    }
+    SlabFreeObject *object = ptr;
+    object->m_next = freeLists[sizeClass];
+    freeLists[sizeClass] = object;
+    statistics.m_nFree++;
+}
+
+int64_t slabGetAllocationCount() { return statistics.m_nAllocation; }
+int64_t slabGetFreeCount() { return statistics.m_nFree; }
+int64_t slabGetChunkCount() { return statistics.m_nChunk; }
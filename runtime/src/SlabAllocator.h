@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Size-class slab allocator for the runtime's small fixed-size objects (Variable, Type and compound type info).
+// Each thread keeps its own free list per size class, so allocation and release are a pointer pop/push.
+// Requests larger than the biggest size class fall back to malloc/free
+
+#define SLAB_GRANULE 16                 // size classes are multiples of this many bytes
+#define SLAB_NUM_SIZE_CLASSES 4         // 16, 32, 48 and 64 bytes
+#define SLAB_OBJECTS_PER_CHUNK 256      // objects carved out of each malloc'ed chunk
+
+void *slabMalloc(size_t size);
+void slabFree(void *ptr, size_t size);  // size must be the one passed to slabMalloc
+
+/// INTERFACE
+// counters of the calling thread
+int64_t slabGetAllocationCount();  // number of slabMalloc calls served from a size class
+int64_t slabGetFreeCount();        // number of slabFree calls returned to a size class
+int64_t slabGetChunkCount();       // number of chunks requested from malloc
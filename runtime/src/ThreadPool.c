@@ -0,0 +1,146 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ThreadPool.h"
+#include "Bool.h"
+
+typedef struct struct_thread_pool_job {
+    ThreadPoolRangeBody m_body;
+    void *m_context;
+    int64_t m_size;
+    int64_t m_chunkSize;
+    int64_t m_nChunk;
+    atomic_int_fast64_t m_nextChunk;  // the next chunk to be claimed, chunks past m_nChunk mean the loop is drained
+    int32_t m_nParticipant;           // workers inside the job, guarded by poolMutex
+} ThreadPoolJob;
+
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobPosted = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t participantLeft = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t submitMutex = PTHREAD_MUTEX_INITIALIZER;  // held by the thread running a parallel loop
+
+static ThreadPoolJob *currentJob;  // NULL once the submitting thread stops letting workers join
+static int64_t jobGeneration;      // bumped for every posted job so sleeping workers can tell a new one apart
+static int32_t numThreads = 1;
+static int64_t threshold = THREAD_POOL_DEFAULT_THRESHOLD;
+static _Thread_local bool isPoolWorker;
+
+/// helpers
+// a missing, malformed or non-positive value gives defaultValue
+static int64_t threadPoolReadEnvironment(const char *name, int64_t defaultValue) {
+    const char *value = getenv(name);
+    if (value == NULL || *value == '\0')
+        return defaultValue;
+    char *end;
+    long long parsed = strtoll(value, &end, 10);
+    if (*end != '\0' || parsed <= 0)
+        return defaultValue;
+    return parsed;
+}
+
+static void threadPoolRunChunks(ThreadPoolJob *job) {
+    for (;;) {
+        int64_t chunk = atomic_fetch_add(&job->m_nextChunk, 1);
+        if (chunk >= job->m_nChunk)
+            return;
+        int64_t begin = chunk * job->m_chunkSize;
+        int64_t end = begin + job->m_chunkSize < job->m_size ? begin + job->m_chunkSize : job->m_size;
+        job->m_body(job->m_context, begin, end);
+    }
+}
+
+static void *threadPoolWorkerMain(void *unused) {
+    isPoolWorker = true;
+    int64_t seenGeneration = 0;
+    pthread_mutex_lock(&poolMutex);
+    for (;;) {
+        while (jobGeneration == seenGeneration)
+            pthread_cond_wait(&jobPosted, &poolMutex);
+        seenGeneration = jobGeneration;
+        ThreadPoolJob *job = currentJob;
+        if (job == NULL)  // woke up after the job was already finished
+            continue;
+        job->m_nParticipant++;
+        pthread_mutex_unlock(&poolMutex);
+
+        threadPoolRunChunks(job);
+
+        pthread_mutex_lock(&poolMutex);
+        if (--job->m_nParticipant == 0)
+            pthread_cond_signal(&participantLeft);
+    }
+    return NULL;
+}
+
+static void threadPoolStart() {
+    threshold = threadPoolReadEnvironment("GAZPREA_PARALLEL_THRESHOLD", THREAD_POOL_DEFAULT_THRESHOLD);
+    long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    int64_t requested = threadPoolReadEnvironment("GAZPREA_NUM_THREADS", numCPUs > 0 ? numCPUs : 1);
+    if (requested > THREAD_POOL_MAX_THREADS)
+        requested = THREAD_POOL_MAX_THREADS;
+
+    // the workers are detached and sleep on jobPosted between loops; exit() takes them down with the process
+    numThreads = 1;
+    for (int64_t i = 1; i < requested; i++) {
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, threadPoolWorkerMain, NULL) != 0)
+            break;
+        pthread_detach(worker);
+        numThreads++;
+    }
+}
+
+/// INTERFACE
+int32_t threadPoolGetNumThreads() {
+    pthread_once(&poolOnce, threadPoolStart);
+    return numThreads;
+}
+
+int64_t threadPoolGetThreshold() {
+    pthread_once(&poolOnce, threadPoolStart);
+    return threshold;
+}
+
+void threadPoolParallelFor(int64_t size, int64_t itemCost, ThreadPoolRangeBody body, void *context) {
+    if (size <= 0)
+        return;
+    if (isPoolWorker || size == 1 || size * itemCost < threadPoolGetThreshold() || numThreads == 1
+        || pthread_mutex_trylock(&submitMutex) != 0) {
+        body(context, 0, size);
+        return;
+    }
+
+    // chunks are kept at least a quarter of the threshold so the claiming overhead stays small
+    int64_t chunkSize = (size + numThreads * THREAD_POOL_CHUNKS_PER_THREAD - 1) / (numThreads * THREAD_POOL_CHUNKS_PER_THREAD);
+    int64_t minChunkSize = (threshold / 4 + itemCost - 1) / itemCost;
+    if (chunkSize < minChunkSize)
+        chunkSize = minChunkSize;
+
+    ThreadPoolJob job;
+    job.m_body = body;
+    job.m_context = context;
+    job.m_size = size;
+    job.m_chunkSize = chunkSize;
+    job.m_nChunk = (size + chunkSize - 1) / chunkSize;
+    atomic_init(&job.m_nextChunk, 0);
+    job.m_nParticipant = 0;
+
+    pthread_mutex_lock(&poolMutex);
+    currentJob = &job;
+    jobGeneration++;
+    pthread_cond_broadcast(&jobPosted);
+    pthread_mutex_unlock(&poolMutex);
+
+    threadPoolRunChunks(&job);
+
+    // every chunk has been claimed; wait for the workers still computing theirs, since job lives on this stack
+    pthread_mutex_lock(&poolMutex);
+    currentJob = NULL;
+    while (job.m_nParticipant > 0)
+        pthread_cond_wait(&participantLeft, &poolMutex);
+    pthread_mutex_unlock(&poolMutex);
+
+    pthread_mutex_unlock(&submitMutex);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// Worker threads shared by the runtime's array kernels. The pool starts on the first parallel loop and has
+// GAZPREA_NUM_THREADS threads counting the caller, or one per online CPU when the variable is unset.
+// A loop is cut into more chunks than there are threads and every thread keeps claiming the next chunk from a
+// shared counter, so threads that finish early take over the work of the ones that are behind
+
+#define THREAD_POOL_MAX_THREADS 256
+#define THREAD_POOL_DEFAULT_THRESHOLD 262144  // units of work below which a loop stays on the calling thread
+#define THREAD_POOL_CHUNKS_PER_THREAD 4
+
+// computes items [begin, end) of a parallel loop
+typedef void (*ThreadPoolRangeBody)(void *context, int64_t begin, int64_t end);
+
+int32_t threadPoolGetNumThreads();
+int64_t threadPoolGetThreshold();  // GAZPREA_PARALLEL_THRESHOLD, or THREAD_POOL_DEFAULT_THRESHOLD when unset
+
+// runs body over items [0, size) and returns once all of them are done; each item costs itemCost units of work.
+// The loop runs on the calling thread alone when its total cost is below the threshold, when it is nested in
+// another parallel loop, or when another thread is already using the pool.
+// body must not call errorAndExit, checks that can fail have to be done before the loop
+void threadPoolParallelFor(int64_t size, int64_t itemCost, ThreadPoolRangeBody body, void *context);
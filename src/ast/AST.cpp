@@ -72,6 +72,9 @@ namespace gazprea {
     }
 
     std::string AST::getText() {
+        if (parseTree == nullptr) {
+            return literalText;
+        }
         return parseTree->getText();
     }
 }
\ No newline at end of file
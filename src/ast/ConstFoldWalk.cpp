@@ -0,0 +1,474 @@
+#include "ConstFoldWalk.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace gazprea {
+
+    ConstFoldWalk::ConstFoldWalk(std::shared_ptr<SymbolTable> symtab) : symtab(symtab) {}
+    ConstFoldWalk::~ConstFoldWalk() {}
+
+    void ConstFoldWalk::visit(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::EXPRESSION_TOKEN:
+                numExprAncestors++;
+                visitChildren(t);
+                numExprAncestors--;
+                break;
+            case GazpreaParser::VAR_DECLARATION_TOKEN:
+                visitVariableDeclaration(t);
+                break;
+            case GazpreaParser::CALL_PROCEDURE_FUNCTION_IN_EXPRESSION:
+            case GazpreaParser::CALL_PROCEDURE_STATEMENT_TOKEN:
+                visitCallArguments(t);
+                break;
+            case GazpreaParser::TUPLE_ACCESS_TOKEN:
+                // the second child is a field name or index, not a value
+                visit(t->children[0]);
+                break;
+            case GazpreaParser::INPUT_STREAM_TOKEN:
+                // reads into its operand, which must stay a variable
+                break;
+            default:
+                visitChildren(t);
+                break;
+        }
+    }
+
+    // Folded expressions are replaced in their parent's children list, so operands are folded before the operation
+    void ConstFoldWalk::visitChildren(std::shared_ptr<AST> t) {
+        for (size_t i = 0; i < t->children.size(); i++) {
+            auto child = t->children[i];
+            if (child->isNil()) {
+                continue;
+            }
+            visit(child);
+            auto folded = fold(child);
+            if (folded != nullptr) {
+                t->children[i] = folded;
+                numExpressionsFolded++;
+            }
+        }
+    }
+
+    void ConstFoldWalk::visitVariableDeclaration(std::shared_ptr<AST> t) {
+        visitChildren(t);
+        auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(t->symbol);
+        if (variableSymbol == nullptr || variableSymbol->typeQualifier != "const" || variableSymbol->type == nullptr
+            || t->children[2]->isNil()) {
+            return;
+        }
+        ConstantValue value;
+        if (!getConstantValue(t->children[2]->children[0], value)) {
+            return;
+        }
+        // the declaration promotes an integer initializer of a real variable
+        auto typeId = variableSymbol->type->getTypeId();
+        if (typeId == Type::REAL && value.typeId == Type::INTEGER) {
+            value.realValue = (float)value.integerValue;
+            value.typeId = Type::REAL;
+        }
+        if (typeId != value.typeId) {
+            return;
+        }
+        auto literal = makeLiteral(value, t->children[2]->children[0]);
+        if (literal != nullptr) {
+            constantValues[variableSymbol] = literal;
+        }
+    }
+
+    // A const variable passed by name must reach the call as a variable, so LLVMGen can reject var parameters
+    void ConstFoldWalk::visitCallArguments(std::shared_ptr<AST> t) {
+        if (t->children[1]->isNil()) {
+            return;
+        }
+        for (auto &expr : t->children[1]->children) {
+            if (expr->children[0]->getNodeType() == GazpreaParser::IDENTIFIER_TOKEN) {
+                continue;
+            }
+            visit(expr);
+        }
+    }
+
+    std::shared_ptr<AST> ConstFoldWalk::fold(std::shared_ptr<AST> t) {
+        if (t->evalType == nullptr) {
+            return nullptr;
+        }
+        switch (t->getNodeType()) {
+            case GazpreaParser::BINARY_OP_TOKEN:
+                return foldBinaryOperation(t);
+            case GazpreaParser::UNARY_TOKEN:
+                return foldUnaryOperation(t);
+            case GazpreaParser::CAST_TOKEN:
+                return foldCast(t);
+            case GazpreaParser::CALL_PROCEDURE_FUNCTION_IN_EXPRESSION:
+                return foldLength(t);
+            case GazpreaParser::IDENTIFIER_TOKEN:
+                return foldIdentifier(t);
+            default:
+                return nullptr;
+        }
+    }
+
+    std::shared_ptr<AST> ConstFoldWalk::foldBinaryOperation(std::shared_ptr<AST> t) {
+        ConstantValue lhs, rhs, result;
+        if (!getConstantValue(t->children[0], lhs) || !getConstantValue(t->children[1], rhs)) {
+            return nullptr;
+        }
+        auto op = t->children[2]->getNodeType();
+
+        if (lhs.typeId == Type::BOOLEAN || rhs.typeId == Type::BOOLEAN) {
+            if (lhs.typeId != rhs.typeId) {
+                return nullptr;
+            }
+            result.typeId = Type::BOOLEAN;
+            switch (op) {
+                case GazpreaParser::AND:
+                    result.booleanValue = lhs.booleanValue && rhs.booleanValue;
+                    break;
+                case GazpreaParser::OR:
+                    result.booleanValue = lhs.booleanValue || rhs.booleanValue;
+                    break;
+                case GazpreaParser::XOR:
+                case GazpreaParser::ISNOTEQUAL:
+                    result.booleanValue = lhs.booleanValue != rhs.booleanValue;
+                    break;
+                case GazpreaParser::ISEQUAL:
+                    result.booleanValue = lhs.booleanValue == rhs.booleanValue;
+                    break;
+                default:
+                    return nullptr;
+            }
+        } else if (lhs.typeId == Type::REAL || rhs.typeId == Type::REAL) {
+            float a = lhs.typeId == Type::REAL ? lhs.realValue : (float)lhs.integerValue;
+            float b = rhs.typeId == Type::REAL ? rhs.realValue : (float)rhs.integerValue;
+            result.typeId = Type::REAL;
+            switch (op) {
+                case GazpreaParser::CARET:
+                    result.realValue = powf(a, b);
+                    break;
+                case GazpreaParser::ASTERISK:
+                    result.realValue = a * b;
+                    break;
+                case GazpreaParser::DIV:
+                    result.realValue = a / b;
+                    break;
+                case GazpreaParser::MODULO:
+                    result.realValue = fmodf(a, b);
+                    break;
+                case GazpreaParser::PLUS:
+                    result.realValue = a + b;
+                    break;
+                case GazpreaParser::MINUS:
+                    result.realValue = a - b;
+                    break;
+                default:
+                    result.typeId = Type::BOOLEAN;
+                    switch (op) {
+                        case GazpreaParser::LESSTHAN:
+                            result.booleanValue = a < b;
+                            break;
+                        case GazpreaParser::GREATERTHAN:
+                            result.booleanValue = a > b;
+                            break;
+                        case GazpreaParser::LESSTHANOREQUAL:
+                            result.booleanValue = a <= b;
+                            break;
+                        case GazpreaParser::GREATERTHANOREQUAL:
+                            result.booleanValue = a >= b;
+                            break;
+                        case GazpreaParser::ISEQUAL:
+                            result.booleanValue = a == b;
+                            break;
+                        case GazpreaParser::ISNOTEQUAL:
+                            result.booleanValue = a != b;
+                            break;
+                        default:
+                            return nullptr;
+                    }
+            }
+        } else {
+            int32_t a = lhs.integerValue;
+            int32_t b = rhs.integerValue;
+            result.typeId = Type::INTEGER;
+            switch (op) {
+                case GazpreaParser::CARET:
+                    if (a == 0 && b < 0) {
+                        return nullptr;
+                    }
+                    result.integerValue = integerExponentiation(a, b);
+                    break;
+                case GazpreaParser::ASTERISK:
+                    result.integerValue = (int32_t)((uint32_t)a * (uint32_t)b);
+                    break;
+                case GazpreaParser::DIV:
+                    if (b == 0 || (a == INT32_MIN && b == -1)) {
+                        return nullptr;
+                    }
+                    result.integerValue = a / b;
+                    break;
+                case GazpreaParser::MODULO:
+                    if (b == 0) {
+                        return nullptr;
+                    }
+                    result.integerValue = (int32_t)((int64_t)a % (int64_t)b);
+                    break;
+                case GazpreaParser::PLUS:
+                    result.integerValue = (int32_t)((uint32_t)a + (uint32_t)b);
+                    break;
+                case GazpreaParser::MINUS:
+                    result.integerValue = (int32_t)((uint32_t)a - (uint32_t)b);
+                    break;
+                default:
+                    result.typeId = Type::BOOLEAN;
+                    switch (op) {
+                        case GazpreaParser::LESSTHAN:
+                            result.booleanValue = a < b;
+                            break;
+                        case GazpreaParser::GREATERTHAN:
+                            result.booleanValue = a > b;
+                            break;
+                        case GazpreaParser::LESSTHANOREQUAL:
+                            result.booleanValue = a <= b;
+                            break;
+                        case GazpreaParser::GREATERTHANOREQUAL:
+                            result.booleanValue = a >= b;
+                            break;
+                        case GazpreaParser::ISEQUAL:
+                            result.booleanValue = a == b;
+                            break;
+                        case GazpreaParser::ISNOTEQUAL:
+                            result.booleanValue = a != b;
+                            break;
+                        default:
+                            return nullptr;
+                    }
+            }
+        }
+        if (result.typeId != t->evalType->getTypeId()) {
+            return nullptr;
+        }
+        return makeLiteral(result, t);
+    }
+
+    std::shared_ptr<AST> ConstFoldWalk::foldUnaryOperation(std::shared_ptr<AST> t) {
+        auto op = t->children[0]->getNodeType();
+        auto operand = t->children[1];
+        ConstantValue value;
+        if (op == GazpreaParser::MINUS && operand->getNodeType() == GazpreaParser::IntegerConstant
+            && operand->getText() == "2147483648") {
+            value.typeId = Type::INTEGER;
+            value.integerValue = INT32_MIN;
+            return makeLiteral(value, t);
+        }
+        if (!getConstantValue(operand, value)) {
+            return nullptr;
+        }
+        switch (op) {
+            case GazpreaParser::PLUS:
+                if (value.typeId == Type::BOOLEAN) {
+                    return nullptr;
+                }
+                break;
+            case GazpreaParser::MINUS:
+                if (value.typeId == Type::INTEGER) {
+                    value.integerValue = (int32_t)(0u - (uint32_t)value.integerValue);
+                } else if (value.typeId == Type::REAL) {
+                    value.realValue = -value.realValue;
+                } else {
+                    return nullptr;
+                }
+                break;
+            default:
+                // "not" operator
+                if (value.typeId != Type::BOOLEAN) {
+                    return nullptr;
+                }
+                value.booleanValue = !value.booleanValue;
+                break;
+        }
+        if (value.typeId != t->evalType->getTypeId()) {
+            return nullptr;
+        }
+        return makeLiteral(value, t);
+    }
+
+    // Only the scalar conversions that cannot fail at runtime are folded
+    std::shared_ptr<AST> ConstFoldWalk::foldCast(std::shared_ptr<AST> t) {
+        ConstantValue value;
+        if (!getConstantValue(t->children[1]->children[0], value)) {
+            return nullptr;
+        }
+        auto typeId = t->evalType->getTypeId();
+        if (typeId == value.typeId) {
+            return makeLiteral(value, t);
+        }
+        switch (typeId) {
+            case Type::INTEGER:
+                if (value.typeId == Type::BOOLEAN) {
+                    value.integerValue = value.booleanValue ? 1 : 0;
+                } else if (value.realValue > -2147483649.0f && value.realValue < 2147483648.0f) {
+                    value.integerValue = (int32_t)value.realValue;
+                } else {
+                    return nullptr;
+                }
+                break;
+            case Type::REAL:
+                value.realValue = value.typeId == Type::BOOLEAN ? (value.booleanValue ? 1.0f : 0.0f) : (float)value.integerValue;
+                break;
+            case Type::BOOLEAN:
+                if (value.typeId != Type::INTEGER) {
+                    return nullptr;
+                }
+                value.booleanValue = value.integerValue != 0;
+                break;
+            default:
+                return nullptr;
+        }
+        value.typeId = typeId;
+        return makeLiteral(value, t);
+    }
+
+    // length() of a vector literal whose elements are all scalar atoms, or of a string literal
+    std::shared_ptr<AST> ConstFoldWalk::foldLength(std::shared_ptr<AST> t) {
+        auto subroutineSymbol = std::dynamic_pointer_cast<SubroutineSymbol>(t->children[0]->symbol);
+        if (subroutineSymbol == nullptr || subroutineSymbol->name != "gazprea.subroutine.length"
+            || t->children[1]->isNil() || t->children[1]->children.size() != 1) {
+            return nullptr;
+        }
+        auto argument = t->children[1]->children[0]->children[0];
+        ConstantValue value;
+        value.typeId = Type::INTEGER;
+        if (argument->getNodeType() == GazpreaParser::StringLiteral) {
+            auto text = argument->getText();
+            for (size_t i = 1; i + 1 < text.length(); i++) {
+                if (text[i] == '\\') {
+                    i++;  // an escape sequence is a single character
+                }
+                value.integerValue++;
+            }
+            return makeLiteral(value, t);
+        }
+        if (argument->getNodeType() != GazpreaParser::VECTOR_LITERAL_TOKEN || argument->children[0]->isNil()
+            || argument->evalType == nullptr) {
+            return nullptr;
+        }
+        switch (argument->evalType->getTypeId()) {
+            case Type::BOOLEAN_1:
+            case Type::CHARACTER_1:
+            case Type::INTEGER_1:
+            case Type::REAL_1:
+                break;
+            default:
+                return nullptr;
+        }
+        for (auto &expr : argument->children[0]->children) {
+            // dropping the vector must not drop a call or a runtime error
+            if (!isAtomicExpression(expr->children[0])) {
+                return nullptr;
+            }
+        }
+        value.integerValue = (int32_t)argument->children[0]->children.size();
+        return makeLiteral(value, t);
+    }
+
+    std::shared_ptr<AST> ConstFoldWalk::foldIdentifier(std::shared_ptr<AST> t) {
+        if (numExprAncestors == 0) {
+            return nullptr;
+        }
+        auto constantValue = constantValues.find(t->symbol);
+        if (constantValue == constantValues.end()) {
+            return nullptr;
+        }
+        auto literal = std::make_shared<AST>(*constantValue->second);
+        literal->promoteToType = t->promoteToType;
+        literal->isExpressionToReplaceIdentityNull = t->isExpressionToReplaceIdentityNull;
+        return literal;
+    }
+
+    bool ConstFoldWalk::getConstantValue(std::shared_ptr<AST> t, ConstantValue &value) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::IntegerConstant: {
+                // "2147483648" is only valid as the operand of a unary minus
+                auto text = t->getText();
+                if (text.length() > 10 || std::stoll(text) > INT32_MAX) {
+                    return false;
+                }
+                value.typeId = Type::INTEGER;
+                value.integerValue = (int32_t)std::stoll(text);
+                return true;
+            }
+            case GazpreaParser::REAL_CONSTANT_TOKEN:
+                value.typeId = Type::REAL;
+                value.realValue = std::strtof(t->getText().c_str(), nullptr);
+                return std::isfinite(value.realValue);
+            case GazpreaParser::BooleanConstant:
+                value.typeId = Type::BOOLEAN;
+                value.booleanValue = t->getText() == "true";
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::shared_ptr<AST> ConstFoldWalk::makeLiteral(ConstantValue &value, std::shared_ptr<AST> replaced) {
+        std::shared_ptr<AST> literal;
+        switch (value.typeId) {
+            case Type::INTEGER:
+                literal = std::make_shared<AST>(GazpreaParser::IntegerConstant);
+                literal->literalText = std::to_string(value.integerValue);
+                break;
+            case Type::REAL: {
+                if (!std::isfinite(value.realValue)) {
+                    return nullptr;  // left to the runtime
+                }
+                char buffer[32];
+                snprintf(buffer, sizeof(buffer), "%.9g", value.realValue);  // enough digits to round trip a float
+                literal = std::make_shared<AST>(GazpreaParser::REAL_CONSTANT_TOKEN);
+                literal->literalText = buffer;
+                break;
+            }
+            default:
+                literal = std::make_shared<AST>(GazpreaParser::BooleanConstant);
+                literal->literalText = value.booleanValue ? "true" : "false";
+                break;
+        }
+        literal->evalType = symtab->getType(value.typeId);
+        literal->promoteToType = replaced->promoteToType;
+        literal->isExpressionToReplaceIdentityNull = replaced->isExpressionToReplaceIdentityNull;
+        return literal;
+    }
+
+    bool ConstFoldWalk::isAtomicExpression(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::IDENTIFIER_TOKEN:
+            case GazpreaParser::IntegerConstant:
+            case GazpreaParser::REAL_CONSTANT_TOKEN:
+            case GazpreaParser::BooleanConstant:
+            case GazpreaParser::CharacterConstant:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Same as the runtime's integerExponentiation, with the overflow of int32_t made explicit
+    int32_t ConstFoldWalk::integerExponentiation(int32_t base, int32_t exponent) {
+        if (base == -1) {
+            return exponent % 2 == 0 ? 1 : -1;
+        } else if (exponent < 0) {
+            return 0;
+        }
+        uint32_t result = 1;
+        uint32_t power = (uint32_t)base;
+        while (exponent != 0) {
+            if (exponent % 2 == 1) {
+                result *= power;
+            }
+            exponent /= 2;
+            power *= power;
+        }
+        return (int32_t)result;
+    }
+}
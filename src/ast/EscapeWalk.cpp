@@ -0,0 +1,75 @@
+#include "EscapeWalk.h"
+
+namespace gazprea {
+
+    EscapeWalk::EscapeWalk() {}
+    EscapeWalk::~EscapeWalk() {}
+
+    // Only consumers whose code generation reads an operand and then frees it with freeExprAtomIfNecessary or
+    // freeExpressionIfNecessary mark it; any other consumer may keep, move or alias its operands
+    void EscapeWalk::visit(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::BINARY_OP_TOKEN:
+            case GazpreaParser::CONCAT_TOKEN:
+                markOperand(t->children[0]);
+                markOperand(t->children[1]);
+                break;
+            case GazpreaParser::INTERVAL:
+                if (t->children.size() == 2) {  // not the interval keyword of a type
+                    markOperand(t->children[0]);
+                    markOperand(t->children[1]);
+                }
+                break;
+            case GazpreaParser::UNARY_TOKEN:
+                markOperand(t->children[1]);
+                break;
+            case GazpreaParser::CAST_TOKEN:
+                markExpression(t->children[1]);
+                break;
+            case GazpreaParser::OUTPUT_STREAM_TOKEN:
+            case GazpreaParser::CONDITIONAL_STATEMENT_TOKEN:
+            case GazpreaParser::ELSEIF_TOKEN:
+            case GazpreaParser::PRE_PREDICATE_LOOP_TOKEN:
+                markExpression(t->children[0]);
+                break;
+            case GazpreaParser::POST_PREDICATE_LOOP_TOKEN:
+                markExpression(t->children[1]);
+                break;
+        }
+        visitChildren(t);
+    }
+
+    void EscapeWalk::visitChildren(std::shared_ptr<AST> t) {
+        for (auto &child : t->children) {
+            if (!child->isNil()) {
+                visit(child);
+            }
+        }
+    }
+
+    void EscapeWalk::markOperand(std::shared_ptr<AST> t) {
+        if (isStackTemporaryProducer(t)) {
+            t->isStackTemporary = true;
+        }
+    }
+
+    void EscapeWalk::markExpression(std::shared_ptr<AST> t) {
+        if (t->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
+            markOperand(t->children[0]);
+        }
+    }
+
+    // Operations whose code generation creates the result Variable through LLVMGen::allocateTemporary
+    bool EscapeWalk::isStackTemporaryProducer(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::BINARY_OP_TOKEN:
+            case GazpreaParser::UNARY_TOKEN:
+            case GazpreaParser::CAST_TOKEN:
+            case GazpreaParser::CONCAT_TOKEN:
+            case GazpreaParser::INTERVAL:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,253 @@
+#include "InlineWalk.h"
+
+namespace gazprea {
+
+    InlineWalk::InlineWalk(std::shared_ptr<SymbolTable> symtab) : symtab(symtab) {}
+    InlineWalk::~InlineWalk() {}
+
+    void InlineWalk::visit(std::shared_ptr<AST> t) {
+        visitChildren(t);
+    }
+
+    // Calls are replaced in their parent's children list once their arguments have been walked,
+    // so calls nested in arguments are inlined first
+    void InlineWalk::visitChildren(std::shared_ptr<AST> t) {
+        for (size_t i = 0; i < t->children.size(); i++) {
+            auto child = t->children[i];
+            if (child->isNil()) {
+                continue;
+            }
+            visit(child);
+            if (child->getNodeType() == GazpreaParser::CALL_PROCEDURE_FUNCTION_IN_EXPRESSION) {
+                auto inlined = inlineCall(child);
+                if (inlined != nullptr) {
+                    t->children[i] = inlined;
+                    numCallsInlined++;
+                }
+            }
+        }
+    }
+
+    // Returns the expression that replaces the call, or nullptr when the call has to stay a call
+    std::shared_ptr<AST> InlineWalk::inlineCall(std::shared_ptr<AST> t) {
+        auto subroutineSymbol = std::dynamic_pointer_cast<SubroutineSymbol>(t->children[0]->symbol);
+        if (subroutineSymbol == nullptr || subroutineSymbol->isBuiltIn || subroutineSymbol->isProcedure
+            || expandingSubroutines.size() >= MAX_INLINE_DEPTH) {
+            return nullptr;
+        }
+        for (auto &expanding : expandingSubroutines) {
+            if (expanding == subroutineSymbol) {
+                return nullptr;  // recursive call
+            }
+        }
+        auto definition = getSubroutineDefinition(subroutineSymbol);
+        if (definition == nullptr) {
+            return nullptr;
+        }
+        auto returnExpr = getReturnExpression(definition);
+        int numNodes = 0;
+        if (returnExpr == nullptr || !isInlinableExpression(returnExpr, numNodes) || numNodes > MAX_INLINE_BODY_SIZE) {
+            return nullptr;
+        }
+
+        // The body is only a drop-in replacement when no parameter or return value promotion would have happened
+        if (!isInlinableScalarType(subroutineSymbol->type) || returnExpr->evalType == nullptr
+            || returnExpr->evalType->getTypeId() != subroutineSymbol->type->getTypeId()) {
+            return nullptr;
+        }
+        std::vector<std::shared_ptr<AST>> argumentExprs;
+        if (!t->children[1]->isNil()) {
+            for (auto &expr : t->children[1]->children) {
+                argumentExprs.push_back(expr->children[0]);
+            }
+        }
+        // with a forward declaration the body may resolve parameters to either parameter list
+        std::map<std::shared_ptr<Symbol>, size_t> parameterIndex;
+        for (auto &subroutineAST : {subroutineSymbol->declaration, subroutineSymbol->definition}) {
+            if (subroutineAST == nullptr || subroutineAST->children[1]->isNil()) {
+                continue;
+            }
+            auto &parameters = subroutineAST->children[1]->children;
+            if (parameters.size() != argumentExprs.size()) {
+                return nullptr;
+            }
+            for (size_t i = 0; i < parameters.size(); i++) {
+                auto parameterSymbol = parameters[i]->symbol;
+                if (parameterSymbol == nullptr || !isInlinableScalarType(parameterSymbol->type)
+                    || argumentExprs[i]->evalType == nullptr
+                    || argumentExprs[i]->evalType->getTypeId() != parameterSymbol->type->getTypeId()) {
+                    return nullptr;
+                }
+                parameterIndex[parameterSymbol] = i;
+            }
+        }
+        if (definition->children[1]->isNil() && !argumentExprs.empty()) {
+            return nullptr;
+        }
+
+        std::vector<int> numUses(argumentExprs.size(), 0);
+        countParameterUses(returnExpr, parameterIndex, numUses);
+        int numNonAtomicArguments = 0;
+        for (size_t i = 0; i < argumentExprs.size(); i++) {
+            if (isAtomicExpression(argumentExprs[i])) {
+                continue;
+            }
+            // an argument is evaluated once per use after substitution, so only atoms may be duplicated or dropped.
+            // The call evaluates its arguments before the body, which keeps side effects and runtime errors in
+            // the same order only if the one non-atomic argument is also the first thing the body evaluates
+            if (numUses[i] != 1 || ++numNonAtomicArguments > 1 || !isEvaluatedFirst(returnExpr, parameterIndex, i)) {
+                return nullptr;
+            }
+        }
+        std::map<std::shared_ptr<Symbol>, std::shared_ptr<AST>> arguments;
+        for (auto &parameter : parameterIndex) {
+            arguments[parameter.first] = argumentExprs[parameter.second];
+        }
+
+        auto inlined = substitute(returnExpr, arguments);
+        inlined->evalType = t->evalType;
+        inlined->promoteToType = t->promoteToType;
+        inlined->isExpressionToReplaceIdentityNull = t->isExpressionToReplaceIdentityNull;
+
+        // the callee's body may call other small functions
+        expandingSubroutines.push_back(subroutineSymbol);
+        auto wrapper = AST::NewNilNode();
+        wrapper->addChild(inlined);
+        visitChildren(wrapper);
+        expandingSubroutines.pop_back();
+        return wrapper->children[0];
+    }
+
+    std::shared_ptr<AST> InlineWalk::getSubroutineDefinition(std::shared_ptr<SubroutineSymbol> subroutineSymbol) {
+        for (auto &t : {subroutineSymbol->definition, subroutineSymbol->declaration}) {
+            if (t != nullptr && t->children[3]->getNodeType() != GazpreaParser::SUBROUTINE_EMPTY_BODY_TOKEN) {
+                return t;
+            }
+        }
+        return nullptr;
+    }
+
+    // The expression of `= expr;` bodies and of block bodies made of a single `return expr;`
+    std::shared_ptr<AST> InlineWalk::getReturnExpression(std::shared_ptr<AST> definition) {
+        auto body = definition->children[3];
+        if (body->getNodeType() == GazpreaParser::SUBROUTINE_EXPRESSION_BODY_TOKEN) {
+            return body->children[0]->children[0];
+        }
+        if (body->getNodeType() == GazpreaParser::SUBROUTINE_BLOCK_BODY_TOKEN) {
+            auto block = body->children[0];
+            if (block->children.size() == 1 && block->children[0]->getNodeType() == GazpreaParser::RETURN
+                && !block->children[0]->children[0]->isNil()) {
+                return block->children[0]->children[0]->children[0];
+            }
+        }
+        return nullptr;
+    }
+
+    bool InlineWalk::isInlinableScalarType(std::shared_ptr<Type> type) {
+        if (type == nullptr) {
+            return false;
+        }
+        switch (type->getTypeId()) {
+            case Type::BOOLEAN:
+            case Type::CHARACTER:
+            case Type::INTEGER:
+            case Type::REAL:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Generators and filters define their own domain variables, which a copy would share with the original
+    bool InlineWalk::isInlinableExpression(std::shared_ptr<AST> t, int &numNodes) {
+        numNodes++;
+        switch (t->getNodeType()) {
+            case GazpreaParser::GENERATOR_TOKEN:
+            case GazpreaParser::FILTER_TOKEN:
+                return false;
+        }
+        for (auto &child : t->children) {
+            if (!isInlinableExpression(child, numNodes)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool InlineWalk::isAtomicExpression(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::IDENTIFIER_TOKEN:
+            case GazpreaParser::IntegerConstant:
+            case GazpreaParser::REAL_CONSTANT_TOKEN:
+            case GazpreaParser::BooleanConstant:
+            case GazpreaParser::CharacterConstant:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void InlineWalk::countParameterUses(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, size_t> &parameterIndex,
+                                        std::vector<int> &numUses) {
+        if (t->getNodeType() == GazpreaParser::IDENTIFIER_TOKEN) {
+            auto parameter = parameterIndex.find(t->symbol);
+            if (parameter != parameterIndex.end()) {
+                numUses[parameter->second]++;
+            }
+        }
+        for (auto &child : t->children) {
+            countParameterUses(child, parameterIndex, numUses);
+        }
+    }
+
+    bool InlineWalk::usesParameter(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, size_t> &parameterIndex,
+                                   size_t index) {
+        std::vector<int> numUses(index + 1, 0);
+        countParameterUses(t, parameterIndex, numUses);
+        return numUses[index] > 0;
+    }
+
+    // Children are evaluated left to right, so the subtrees evaluated before the parameter are the ones to the left
+    // of the path leading to it. Leaves such as literals and operator tokens cannot fail or have side effects
+    bool InlineWalk::isEvaluatedFirst(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, size_t> &parameterIndex,
+                                      size_t index) {
+        if (t->getNodeType() == GazpreaParser::IDENTIFIER_TOKEN) {
+            auto parameter = parameterIndex.find(t->symbol);
+            return parameter != parameterIndex.end() && parameter->second == index;
+        }
+        for (auto &child : t->children) {
+            if (usesParameter(child, parameterIndex, index)) {
+                return isEvaluatedFirst(child, parameterIndex, index);
+            }
+            if (!child->children.empty()) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Copies the callee's expression, replacing each parameter reference with a copy of its argument
+    std::shared_ptr<AST> InlineWalk::substitute(std::shared_ptr<AST> t, std::map<std::shared_ptr<Symbol>, std::shared_ptr<AST>> &arguments) {
+        if (t->getNodeType() == GazpreaParser::IDENTIFIER_TOKEN) {
+            auto argument = arguments.find(t->symbol);
+            if (argument != arguments.end()) {
+                auto copy = cloneTree(argument->second);
+                copy->promoteToType = t->promoteToType;
+                return copy;
+            }
+        }
+        auto copy = std::make_shared<AST>(*t);
+        for (auto &child : copy->children) {
+            child = substitute(child, arguments);
+        }
+        return copy;
+    }
+
+    std::shared_ptr<AST> InlineWalk::cloneTree(std::shared_ptr<AST> t) {
+        auto copy = std::make_shared<AST>(*t);
+        for (auto &child : copy->children) {
+            child = cloneTree(child);
+        }
+        return copy;
+    }
+}
@@ -6,8 +6,9 @@ namespace gazprea
     LLVMGen::LLVMGen(
         std::shared_ptr<SymbolTable> symtab,
         std::shared_ptr<TypePromote> tp,
-        std::string &outfile)
-        : symtab(symtab), globalCtx(), ir(globalCtx), mod("gazprea", globalCtx), outfile(outfile),
+        std::string &outfile,
+        unsigned optLevel)
+        : symtab(symtab), globalCtx(), optLevel(optLevel), ir(globalCtx, optLevel > 0), mod("gazprea", globalCtx), outfile(outfile),
           llvmFunction(&globalCtx, &ir, &mod),
           llvmBranch(&globalCtx, &ir, &mod),
           numExprAncestors(0),
@@ -23,20 +24,40 @@ namespace gazprea
             },
             "RuntimeType");
 
+        // mirrors the runtime ArrayType, the compound type info of scalars, vectors and matrices
+        runtimeArrayTypeTy = llvm::StructType::create(
+            globalCtx,
+            {
+                ir.getInt32Ty(), // m_elementTypeID
+                ir.getInt8Ty(), // m_nDim
+                llvm::ArrayType::get(ir.getInt64Ty(), 2), // m_dims
+                ir.getInt64Ty(), // m_totalLength
+                ir.getInt64Ty(), // m_elementSize
+                ir.getInt32Ty()->getPointerTo(), // m_refCount
+                ir.getInt32Ty(), // m_isString
+                ir.getInt32Ty(), // m_isRef
+                ir.getInt32Ty(), // m_isSelfRef
+                ir.getInt32Ty() // m_isBorrowed
+            },
+            "RuntimeArrayType");
+
         runtimeVariableTy = llvm::StructType::create(
             globalCtx,
             {
                 runtimeTypeTy->getPointerTo(),
                 ir.getInt8PtrTy(), // llvm does not have void*, the equivalent is int8*
                 ir.getInt64Ty(),
-                ir.getInt8PtrTy() // llvm does not have void*, the equivalent is int8*
+                ir.getInt8PtrTy(), // llvm does not have void*, the equivalent is int8*
+                ir.getInt32Ty(), // bool in runtime is int32_t; needed so alloca'd variables have the full size
+                llvm::ArrayType::get(ir.getInt64Ty(), 2) // m_inlineData
             },
             "RuntimeVariable");
         
         runtimeStackItemTy = llvm::StructType::create(
             globalCtx, {
                 ir.getInt32Ty(),
-                ir.getInt8PtrTy()
+                ir.getInt8PtrTy(),
+                ir.getInt8PtrTy()   // arena chunk
             },
             "RuntimeStackItemTy"
         );
@@ -45,7 +66,8 @@ namespace gazprea
             globalCtx, {
                 ir.getInt64Ty(),
                 ir.getInt64Ty(),
-                runtimeStackItemTy->getPointerTo()
+                runtimeStackItemTy->getPointerTo(),
+                ir.getInt8PtrTy()   // arena chunk
             },
             "RuntimeStackTy"
         );
@@ -55,6 +77,7 @@ namespace gazprea
         llvmFunction.runtimeStackTy = runtimeStackTy;
         llvmFunction.runtimeStackItemTy = runtimeStackItemTy;
         llvmFunction.declareAllFunctions();
+        initializeTargetMachine();
 
         // Declare Global Variables
         for (auto variableSymbol : symtab->globals->globalVariableSymbols) {
@@ -69,10 +92,9 @@ namespace gazprea
         globalVar->setLinkage(llvm::GlobalValue::InternalLinkage);
         globalVar->setInitializer(llvm::ConstantPointerNull::get(runtimeStackTy->getPointerTo()));
         globalStack = globalVar;
-    }
 
-    LLVMGen::~LLVMGen() {
-        Print();
+        mod.getOrInsertGlobal("internedTypes", llvm::ArrayType::get(runtimeTypeTy, NUM_INTERNED_TYPES));
+        internedTypes = mod.getNamedGlobal("internedTypes");
     }
 
     void LLVMGen::visit(std::shared_ptr<AST> t) {
@@ -215,9 +237,73 @@ namespace gazprea
         for (auto child : t->children) visit(child);
     }
 
+    // Scalar and interval types carry no size, so codegen refers to the runtime's shared instance instead of
+    // building a Type for every declaration
+    llvm::Value* LLVMGen::getInternedRuntimeType(int internedTypeId) {
+        auto arrayTy = llvm::ArrayType::get(runtimeTypeTy, NUM_INTERNED_TYPES);
+        return ir.CreateConstInBoundsGEP2_32(arrayTy, internedTypes, 0, internedTypeId);
+    }
+
+    int LLVMGen::getInternedTypeId(int typeId) {
+        switch (typeId) {
+            case Type::BOOLEAN:
+                return INTERNED_TYPE_BOOLEAN_SCALAR;
+            case Type::CHARACTER:
+                return INTERNED_TYPE_CHARACTER_SCALAR;
+            case Type::INTEGER:
+                return INTERNED_TYPE_INTEGER_SCALAR;
+            case Type::REAL:
+                return INTERNED_TYPE_REAL_SCALAR;
+            case Type::INTEGER_INTERVAL:
+                return INTERNED_TYPE_INTEGER_INTERVAL;
+            default:
+                return -1;
+        }
+    }
+
     llvm::Value* LLVMGen::getStack() { 
         return ir.CreateLoad(runtimeStackTy->getPointerTo(), globalStack);
     }
+
+    bool LLVMGen::isStackAllocatableType(std::shared_ptr<Type> type) {
+        if (type == nullptr) {
+            return false;
+        }
+        switch (type->getTypeId()) {
+            case Type::BOOLEAN:
+            case Type::CHARACTER:
+            case Type::INTEGER:
+            case Type::REAL:
+                return true;
+            case Type::TUPLE: {
+                std::shared_ptr<TupleType> tupleType = nullptr;
+                if (type->isTypedefType()) {
+                    auto typedefType = std::dynamic_pointer_cast<TypedefTypeSymbol>(type);
+                    tupleType = std::dynamic_pointer_cast<TupleType>(typedefType->type);
+                } else {
+                    tupleType = std::dynamic_pointer_cast<TupleType>(type);
+                }
+                if (tupleType == nullptr) {
+                    return false;
+                }
+                for (auto field : tupleType->orderedArgs) {
+                    if (field->type == nullptr || field->type->getTypeId() == Type::TUPLE || !isStackAllocatableType(field->type)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // allocas are placed in the entry block so they are allocated once per call even when declared inside a loop
+    llvm::Value* LLVMGen::createEntryBlockVariableAlloca(const std::string& name) {
+        llvm::BasicBlock& entryBB = ir.GetInsertBlock()->getParent()->getEntryBlock();
+        llvm::IRBuilder<llvm::NoFolder> entryBuilder(&entryBB, entryBB.begin());
+        return entryBuilder.CreateAlloca(runtimeVariableTy, nullptr, name);
+    }
     
     void LLVMGen::visitSubroutineDeclDef(std::shared_ptr<AST> t) {
         auto subroutineSymbol = std::dynamic_pointer_cast<SubroutineSymbol>(t->symbol);
@@ -272,10 +358,8 @@ namespace gazprea
             visit(t->children[3]);  // Visit Body
 
             auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
-            llvmFunction.call("variableInitFromDeclaration", { runtimeVariableObject, t->children[2]->llvmValue, t->children[3]->children[0]->llvmValue });
+            initializeDeclaredVariable(runtimeVariableObject, t->children[2]->llvmValue, t->children[3]->children[0]);
             llvmFunction.call("typeDestructThenFree", t->children[2]->llvmValue);
-            
-            freeExpressionIfNecessary(t->children[3]->children[0]);
             freeSubroutineParameters(subroutineSymbol);
             
             if (subroutineSymbol->name == "gazprea.subroutine.main") {
@@ -320,10 +404,8 @@ namespace gazprea
         isExpressionToReplaceIdentityNull = false;
 
         auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
-        llvmFunction.call("variableInitFromDeclaration", { runtimeVariableObject, subroutineSymbol->declaration->children[2]->llvmValue, t->children[0]->llvmValue });
+        initializeDeclaredVariable(runtimeVariableObject, subroutineSymbol->declaration->children[2]->llvmValue, t->children[0]);
         llvmFunction.call("typeDestructThenFree", subroutineSymbol->declaration->children[2]->llvmValue);
-        
-        freeExpressionIfNecessary(t->children[0]);
         freeSubroutineParameters(subroutineSymbol);
         
         if (subroutineSymbol->name == "gazprea.subroutine.main") {
@@ -362,14 +444,18 @@ namespace gazprea
         }
 
         // Handle identity/null in expression in vector/matrix declaration
-        auto runtimeIntegerType = llvmFunction.call("typeMalloc", {});
-        llvmFunction.call("typeInitFromIntegerScalar", { runtimeIntegerType });
-        llvmVarDeclarationLHSType = runtimeIntegerType;
+        llvmVarDeclarationLHSType = getInternedRuntimeType(INTERNED_TYPE_INTEGER_SCALAR);
         visit(t->children[0]);
-        llvmFunction.call("typeDestructThenFree", runtimeIntegerType);
         llvmVarDeclarationLHSType = nullptr;
 
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        llvm::Value* runtimeVariableObject;
+        if (isStackAllocatableType(variableSymbol->type)) {
+            // Fixed-size scalar (or tuple of scalars) local: keep the Variable in the stack frame, only its contents go through the runtime
+            runtimeVariableObject = createEntryBlockVariableAlloca(variableSymbol->name);
+            variableSymbol->isStackAllocated = true;
+        } else {
+            runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        }
         if (t->children[2]->isNil()) {
             // No expression => Initialize to null
             auto runtimeTypeObject = t->children[0]->children[1]->llvmValue;
@@ -381,12 +467,9 @@ namespace gazprea
         } else if (t->children[0]->getNodeType() == GazpreaParser::INFERRED_TYPE_TOKEN) {
             llvmVarDeclarationLHSType = nullptr;
             visit(t->children[2]);
-            auto runtimeTypeObject = llvmFunction.call("typeMalloc", {});
-            llvmFunction.call("typeInitFromUnknownType", { runtimeTypeObject });
-            llvmFunction.call("variableInitFromDeclaration", {runtimeVariableObject, runtimeTypeObject, t->children[2]->llvmValue});
+            auto runtimeTypeObject = getInternedRuntimeType(INTERNED_TYPE_UNKNOWN);
+            initializeDeclaredVariable(runtimeVariableObject, runtimeTypeObject, t->children[2]);
             variableSymbol->llvmPointerToTypeObject = runtimeTypeObject;
-            
-            freeExpressionIfNecessary(t->children[2]);
             llvmFunction.call("typeDestructThenFree", runtimeTypeObject);
         } else {
             auto runtimeTypeObject = t->children[0]->children[1]->llvmValue;
@@ -396,10 +479,8 @@ namespace gazprea
             visit(t->children[2]);
             isExpressionToReplaceIdentityNull = false;
 
-            llvmFunction.call("variableInitFromDeclaration", {runtimeVariableObject, runtimeTypeObject, t->children[2]->llvmValue});
+            initializeDeclaredVariable(runtimeVariableObject, runtimeTypeObject, t->children[2]);
             variableSymbol->llvmPointerToTypeObject = runtimeTypeObject;
-
-            freeExpressionIfNecessary(t->children[2]);
             llvmFunction.call("typeDestructThenFree", runtimeTypeObject);
         }
         
@@ -407,12 +488,27 @@ namespace gazprea
         variableSymbol->llvmPointerToVariableObject = runtimeVariableObject;
     }
 
+    // Initializes a declared variable or return value from expression t, taking over t if it is a temporary
+    void LLVMGen::initializeDeclaredVariable(llvm::Value *runtimeVariableObject, llvm::Value *runtimeTypeObject, std::shared_ptr<AST> t) {
+        if (isTemporaryExpression(t)) {
+            llvmFunction.call("variableInitFromDeclarationMove", {runtimeVariableObject, runtimeTypeObject, t->llvmValue});
+        } else {
+            llvmFunction.call("variableInitFromDeclaration", {runtimeVariableObject, runtimeTypeObject, t->llvmValue});
+        }
+    }
+
     void LLVMGen::visitAssignmentStatement(std::shared_ptr<AST> t) {
-        visitChildren(t);
+        isIndexingWriteTarget = true;
+        visit(t->children[0]);
+        isIndexingWriteTarget = false;
+        visit(t->children[1]);
         auto numLHSExpressions = t->children[0]->children.size();
         if (numLHSExpressions == 1) {
-            llvmFunction.call("variableAssignment", {t->children[0]->children[0]->llvmValue, t->children[1]->llvmValue});
-            freeExpressionIfNecessary(t->children[1]);
+            if (isTemporaryExpression(t->children[1])) {
+                llvmFunction.call("variableAssignMove", {t->children[0]->children[0]->llvmValue, t->children[1]->llvmValue});
+            } else {
+                llvmFunction.call("variableAssignment", {t->children[0]->children[0]->llvmValue, t->children[1]->llvmValue});
+            }
             freeExpressionIfNecessary(t->children[0]->children[0]);
             return;
         }
@@ -426,6 +522,11 @@ namespace gazprea
     }
 
     void LLVMGen::visitUnqualifiedType(std::shared_ptr<AST> t) {
+        auto internedTypeId = getInternedTypeId(t->type->getTypeId());
+        if (internedTypeId != -1) {
+            t->llvmValue = getInternedRuntimeType(internedTypeId);
+            return;
+        }
         auto runtimeTypeObject = llvmFunction.call("typeMalloc", {});
 
         std::shared_ptr<MatrixType> matrixType;
@@ -506,10 +607,8 @@ namespace gazprea
                 } else {
                     dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromBooleanScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_BOOLEAN_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", { runtimeTypeObject, dimension1Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -528,10 +627,8 @@ namespace gazprea
                 } else {
                     dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromCharacterScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_CHARACTER_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", { runtimeTypeObject, dimension1Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -550,10 +647,8 @@ namespace gazprea
                 } else {
                     dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromIntegerScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_INTEGER_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", { runtimeTypeObject, dimension1Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
 
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
@@ -573,10 +668,8 @@ namespace gazprea
                 } else {
                     dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromRealScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_REAL_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", { runtimeTypeObject, dimension1Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -601,10 +694,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromBooleanScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_BOOLEAN_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", { runtimeTypeObject, dimension1Expression, dimension2Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -631,10 +722,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromCharacterScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_CHARACTER_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", { runtimeTypeObject, dimension1Expression, dimension2Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -662,10 +751,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromIntegerScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_INTEGER_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", { runtimeTypeObject, dimension1Expression, dimension2Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -693,10 +780,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo());
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromRealScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_REAL_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", { runtimeTypeObject, dimension1Expression, dimension2Expression, baseType });
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -754,13 +839,8 @@ namespace gazprea
         // Start inserting at If Header 
         ir.CreateBr(IfHeaderBB);
         ir.SetInsertPoint(IfHeaderBB);
-        visit(t->children[0]); 
         // setup branch condition
-        auto exprValue = llvmFunction.call("variableGetBooleanValue", {t->children[0]->llvmValue}); //HERE
-
-        freeExpressionIfNecessary(t->children[0]);
-
-        llvm::Value* ifCondition = ir.CreateICmpNE(exprValue, ir.getInt32(0));
+        llvm::Value* ifCondition = createConditionValue(t->children[0]);
         if ((!ctx->elseStatement() && numChildren > 2) || (ctx->elseStatement() && numChildren > 3)) {
             ir.CreateCondBr(ifCondition, IfBodyBB, ElseIfHeader); 
         } else if(ctx->elseStatement()) {
@@ -789,12 +869,7 @@ namespace gazprea
                 ir.SetInsertPoint(ElseIfHeader);
             }
             //Fill header
-            visit(elifNode->children[0]); 
-            auto elseIfExprValue = llvmFunction.call("variableGetBooleanValue", {elifNode->children[0]->llvmValue});
-            
-            freeExpressionIfNecessary(elifNode->children[0]);
-            
-            llvm::Value* elseIfCondition = ir.CreateICmpNE(elseIfExprValue, ir.getInt32(0));
+            llvm::Value* elseIfCondition = createConditionValue(elifNode->children[0]);
             llvm::BasicBlock* elseIfBodyBlock = llvm::BasicBlock::Create(globalCtx, "ElseIfBody", parentFunc);
             // Conditional Branch Out (3 Cases)
             if (!ctx->elseStatement() && elseIfIdx == (numChildren -1)) {           // 1) last else if no else
@@ -910,11 +985,7 @@ namespace gazprea
 
     void LLVMGen::visitPrePredicatedLoop(std::shared_ptr<AST> t) {
         llvmBranch.createPrePredConditionalBB("PrePredLoop");
-        visit(t->children[0]);      // Conditional Expr
-        auto exprValue = llvmFunction.call("variableGetBooleanValue", {t->children[0]->llvmValue});
-        freeExpressionIfNecessary(t->children[0]);
-        
-        llvm::Value* condition = ir.CreateICmpNE(exprValue, ir.getInt32(0)); 
+        llvm::Value* condition = createConditionValue(t->children[0]);      // Conditional Expr
         llvmBranch.createPrePredBodyBB(condition);
         llvmBranch.hitReturnStat = false;
         visit(t->children[1]);      // Visit body
@@ -926,12 +997,7 @@ namespace gazprea
         llvmBranch.hitReturnStat = false;
         visit(t->children[0]);      //visit Body  
         llvmBranch.createPostPredConditionalBB(); 
-        visit(t->children[1]);      //grab value from post predicate
-        auto exprValue = llvmFunction.call("variableGetBooleanValue", {t->children[1]->llvmValue});
-
-        freeExpressionIfNecessary(t->children[1]);
-        
-        llvm::Value *condition = ir.CreateICmpNE(exprValue, ir.getInt32(0));
+        llvm::Value *condition = createConditionValue(t->children[1]);      //grab value from post predicate
         llvmBranch.createPostPredMergeBB(condition);
     }
  
@@ -1100,7 +1166,7 @@ namespace gazprea
 
     void LLVMGen::visitBooleanAtom(std::shared_ptr<AST> t) {
         bool booleanValue = 0;
-        if (t->parseTree->getText() == "true") {
+        if (t->getText() == "true") {
             booleanValue = 1;
         }
         auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
@@ -1109,6 +1175,13 @@ namespace gazprea
     }
 
     void LLVMGen::visitCharacterAtom(std::shared_ptr<AST> t) {
+        char characterValue = getCharacterAtomValue(t);
+        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        llvmFunction.call("variableInitFromCharacterScalar", {runtimeVariableObject, ir.getInt8(characterValue)});
+        t->llvmValue = runtimeVariableObject;
+    }
+
+    char LLVMGen::getCharacterAtomValue(std::shared_ptr<AST> t) {
         char characterValue;
         if (t->parseTree->getText().length() == 4) {
             switch (t->parseTree->getText()[2]) {
@@ -1140,20 +1213,18 @@ namespace gazprea
         } else {
             characterValue = t->parseTree->getText()[1];
         }
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
-        llvmFunction.call("variableInitFromCharacterScalar", {runtimeVariableObject, ir.getInt8(characterValue)});
-        t->llvmValue = runtimeVariableObject;
+        return characterValue;
     }
 
     void LLVMGen::visitIntegerAtom(std::shared_ptr<AST> t) {
-        auto integerValue = std::stoi(t->parseTree->getText());
+        auto integerValue = std::stoi(t->getText());
         auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
         llvmFunction.call("variableInitFromIntegerScalar", {runtimeVariableObject, ir.getInt32(integerValue)});
         t->llvmValue = runtimeVariableObject;
     }
 
     void LLVMGen::visitRealAtom(std::shared_ptr<AST> t) {
-        auto realValue = std::stof(t->parseTree->getText());
+        auto realValue = std::stof(t->getText());
         auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
         llvmFunction.call("variableInitFromRealScalar", {runtimeVariableObject, llvm::ConstantFP::get(ir.getFloatTy(), realValue)});
         t->llvmValue = runtimeVariableObject;
@@ -1203,12 +1274,8 @@ namespace gazprea
     void LLVMGen::visitStringLiteral(std::shared_ptr<AST> t) {
         visitChildren(t);
         std::string stringChars = unescapeString(t->parseTree->getText().substr(1, t->parseTree->getText().length() - 2));
-        auto stringLength = stringChars.length();
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
-        llvm::StringRef string = llvm::StringRef(stringChars.c_str());
-        llvm::Value* myStr = ir.CreateGlobalStringPtr(string);
-        llvmFunction.call("variableInitFromString", { runtimeVariableObject, ir.getInt64(stringLength), myStr});
-        t->llvmValue = runtimeVariableObject;
+        auto values = llvm::ConstantDataArray::getString(globalCtx, stringChars, false);
+        t->llvmValue = createConstantArrayVariable(values, true, ELEMENT_CHARACTER, 1, stringChars.length(), 0);
     }
 
     void LLVMGen::visitIdentifier(std::shared_ptr<AST> t) {
@@ -1281,12 +1348,10 @@ namespace gazprea
             initializeVariableSymbol(variableAST, runtimeDomainVar);  
             visit(t->children[1]); //evaluate RHS expression with current domain variable value 
 
-            auto exprVar = llvmFunction.call("variableMalloc", {});
-            llvmFunction.call("variableInitFromMemcpy", {exprVar, t->children[1]->llvmValue});
+            auto exprVar = takeExpressionValue(t->children[1]);
             llvmFunction.call("variableArraySet", {generatorArray, index_i64, exprVar}); 
             // free what we can
             llvmFunction.call("variableDestructThenFree", {runtimeDomainVar});
-            freeExpressionIfNecessary(t->children[1]);
 
             //increment the index variable
             incrementIndex(indexVariable, 1); 
@@ -1401,10 +1466,8 @@ namespace gazprea
             visit(t->children[1]);
             
             //set row to computed value
-            auto exprVar = llvmFunction.call("variableMalloc", {});
-            llvmFunction.call("variableInitFromMemcpy", {exprVar, t->children[1]->llvmValue});
+            auto exprVar = takeExpressionValue(t->children[1]);
             llvmFunction.call("variableArraySet", {matrixRow, innerIndex_i64, exprVar});
-            freeExpressionIfNecessary(t->children[1]);
 
             incrementIndex(innerIndex, 1); // increment the inner index
             ir.CreateBr(innerHeader);
@@ -1549,12 +1612,10 @@ namespace gazprea
             visit(t->children[1]->children[i]);
             
             //get boolean value from ast
-            auto exprVar = llvmFunction.call("variableMalloc", {});
-            llvmFunction.call("variableInitFromMemcpy", {exprVar, t->children[1]->children[i]->llvmValue});
+            auto exprVar = takeExpressionValue(t->children[1]->children[i]);
             llvm::Value *boolValue = llvmFunction.call("variableGetBooleanValue", {exprVar});
             auto filterIdx = ir.getInt64(i);
             auto domainIdx = ir.CreateIntCast(llvmFunction.call("variableGetIntegerValue", {domainIndexVar}), ir.getInt64Ty(),false);
-            freeExpressionIfNecessary(t->children[1]->children[i]);
             llvmFunction.call("variableDestructThenFree", {exprVar});
 
             //set the accept matrix
@@ -1587,7 +1648,7 @@ namespace gazprea
 
     void LLVMGen::visitCast(std::shared_ptr<AST> t) {
         visitChildren(t);
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        auto runtimeVariableObject = allocateTemporary(t);
         llvmFunction.call("variableInitFromCast", { runtimeVariableObject, t->children[0]->llvmValue, t->children[1]->llvmValue });
         t->llvmValue = runtimeVariableObject;
         llvmFunction.call("typeDestructThenFree", t->children[0]->llvmValue);
@@ -1600,7 +1661,10 @@ namespace gazprea
     }
 
     void LLVMGen::visitInputStreamStatement(std::shared_ptr<AST> t) {
-        visitChildren(t);
+        isIndexingWriteTarget = true;
+        visit(t->children[0]);
+        isIndexingWriteTarget = false;
+        visit(t->children[1]);
         llvmFunction.call("variableReadFromStdin", { t->children[0]->llvmValue });
     }
 
@@ -1612,65 +1676,19 @@ namespace gazprea
     }
 
     void LLVMGen::visitBinaryOperation(std::shared_ptr<AST> t) {
-        visitChildren(t);
-        int opCode;
-        switch (t->children[2]->getNodeType()) {
-            case GazpreaParser::CARET: // Character '*'
-                opCode = 2;
-                break;
-            case GazpreaParser::ASTERISK:
-                opCode = 3;
-                break;
-            case GazpreaParser::DIV:
-                opCode = 4;
-                break;
-            case GazpreaParser::MODULO:
-                opCode = 5;
-                break;
-            case GazpreaParser::DOTPRODUCT:
-                opCode = 6;
-                break;
-            case GazpreaParser::PLUS:
-                opCode = 7;
-                break;
-            case GazpreaParser::MINUS:
-                opCode = 8;
-                break;
-            case GazpreaParser::BY:
-                opCode = 9;
-                break;
-            case GazpreaParser::LESSTHAN:
-                opCode = 10;
-                break;
-            case GazpreaParser::GREATERTHAN:
-                opCode = 11;
-                break;
-            case GazpreaParser::LESSTHANOREQUAL:
-                opCode = 12;
-                break;
-            case GazpreaParser::GREATERTHANOREQUAL:
-                opCode = 13;
-                break;
-            case GazpreaParser::ISEQUAL:
-                opCode = 14;
-                break;
-            case GazpreaParser::ISNOTEQUAL:
-                opCode = 15;
-                break;
-            case GazpreaParser::AND:
-                opCode = 16;
-                break;
-            case GazpreaParser::OR:
-                opCode = 17;
-                break;
-            case GazpreaParser::XOR:
-                opCode = 18;
-                break;
-            default:
-                opCode = -1;
+        if (canUnboxOperation(t)) {
+            // Compute the whole scalar sub-expression natively and box the result once
+            t->llvmValue = boxScalar(visitUnboxedBinaryOperation(t), t);
+            return;
         }
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
-        llvmFunction.call("variableInitFromBinaryOp", {runtimeVariableObject, t->children[0]->llvmValue, t->children[1]->llvmValue, ir.getInt32(opCode)});
+        if (canFuseArrayExpression(t)) {
+            visitFusedArrayExpression(t);
+            return;
+        }
+        visitChildren(t);
+        int opCode = getBinaryOpCode(t);
+        auto runtimeVariableObject = allocateTemporary(t);
+        llvmFunction.call(getBinaryOperationEntryPoint(t), {runtimeVariableObject, t->children[0]->llvmValue, t->children[1]->llvmValue, ir.getInt32(opCode)});
         t->llvmValue = runtimeVariableObject;
 
         freeExprAtomIfNecessary(t->children[0]);
@@ -1680,13 +1698,17 @@ namespace gazprea
     void LLVMGen::visitUnaryOperation(std::shared_ptr<AST> t) {
         if (t->children[0]->getNodeType() == GazpreaParser::MINUS 
         && t->children[1]->getNodeType() == GazpreaParser::IntegerConstant
-        && t->children[1]->parseTree->getText() == "2147483648") {
+        && t->children[1]->getText() == "2147483648") {
             // Handle the edge case: integer x = -2147483648;
-            auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+            auto runtimeVariableObject = allocateTemporary(t);
             llvmFunction.call("variableInitFromIntegerScalar", {runtimeVariableObject, ir.getInt32(-2147483648)});
             t->llvmValue = runtimeVariableObject;
             return;
         }
+        if (canUnboxOperation(t)) {
+            t->llvmValue = boxScalar(visitUnboxedUnaryOperation(t), t);
+            return;
+        }
         visitChildren(t);
         int opCode;
         switch (t->children[0]->getNodeType()) {
@@ -1701,7 +1723,7 @@ namespace gazprea
             opCode = 2;
             break;
         }
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        auto runtimeVariableObject = allocateTemporary(t);
         llvmFunction.call("variableInitFromUnaryOp", {runtimeVariableObject, t->children[1]->llvmValue, ir.getInt32(opCode)});
         t->llvmValue = runtimeVariableObject;
 
@@ -1709,7 +1731,16 @@ namespace gazprea
     }
 
     void LLVMGen::visitIndexing(std::shared_ptr<AST> t) {
-        visitChildren(t);
+        // only the indexed array is written through, the indices are read
+        bool isWriteTarget = isIndexingWriteTarget;
+        visit(t->children[0]);
+        isIndexingWriteTarget = false;
+        visit(t->children[1]);
+        isIndexingWriteTarget = isWriteTarget;
+        if (isWriteTarget) {
+            // the reference created below writes to the array's data, which may still be shared with its copies
+            llvmFunction.call("variableNDArrayMakeUnique", {t->children[0]->llvmValue});
+        }
         auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
         auto numRHSExpressions = t->children[1]->children.size();
         if (numRHSExpressions == 1) {
@@ -1740,8 +1771,17 @@ namespace gazprea
     }
 
     void LLVMGen::visitInterval(std::shared_ptr<AST> t) {
+        if (t->children[0]->getNodeType() == GazpreaParser::IntegerConstant
+        && t->children[1]->getNodeType() == GazpreaParser::IntegerConstant) {
+            // Bounds folded to literals by ConstFoldWalk
+            auto runtimeVariableObject = allocateTemporary(t);
+            llvmFunction.call("variableInitFromIntegerInterval", {runtimeVariableObject,
+                ir.getInt32(std::stoi(t->children[0]->getText())), ir.getInt32(std::stoi(t->children[1]->getText()))});
+            t->llvmValue = runtimeVariableObject;
+            return;
+        }
         visitChildren(t);
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        auto runtimeVariableObject = allocateTemporary(t);
         llvmFunction.call("variableInitFromBinaryOp", {runtimeVariableObject, t->children[0]->llvmValue, t->children[1]->llvmValue, ir.getInt32(1)});
         t->llvmValue = runtimeVariableObject;
 
@@ -1751,7 +1791,7 @@ namespace gazprea
 
     void LLVMGen::visitConcatenation(std::shared_ptr<AST> t) {
         visitChildren(t);
-        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        auto runtimeVariableObject = allocateTemporary(t);
         llvmFunction.call("variableInitFromBinaryOp", {runtimeVariableObject, t->children[0]->llvmValue, t->children[1]->llvmValue, ir.getInt32(19)});
         t->llvmValue = runtimeVariableObject;
 
@@ -1759,8 +1799,642 @@ namespace gazprea
         freeExprAtomIfNecessary(t->children[1]);
     }
 
+    // Mirrors BinOpCode in runtime/src/Enums.h; -1 for operators the runtime has no binary op for
+    int LLVMGen::getBinaryOpCode(std::shared_ptr<AST> t) {
+        switch (t->children[2]->getNodeType()) {
+            case GazpreaParser::CARET: // Character '*'
+                return 2;
+            case GazpreaParser::ASTERISK:
+                return 3;
+            case GazpreaParser::DIV:
+                return 4;
+            case GazpreaParser::MODULO:
+                return 5;
+            case GazpreaParser::DOTPRODUCT:
+                return 6;
+            case GazpreaParser::PLUS:
+                return 7;
+            case GazpreaParser::MINUS:
+                return 8;
+            case GazpreaParser::BY:
+                return 9;
+            case GazpreaParser::LESSTHAN:
+                return 10;
+            case GazpreaParser::GREATERTHAN:
+                return 11;
+            case GazpreaParser::LESSTHANOREQUAL:
+                return 12;
+            case GazpreaParser::GREATERTHANOREQUAL:
+                return 13;
+            case GazpreaParser::ISEQUAL:
+                return 14;
+            case GazpreaParser::ISNOTEQUAL:
+                return 15;
+            case GazpreaParser::AND:
+                return 16;
+            case GazpreaParser::OR:
+                return 17;
+            case GazpreaParser::XOR:
+                return 18;
+            default:
+                return -1;
+        }
+    }
+
+    // ELEMENT_INTEGER or ELEMENT_REAL for integer and real scalars, vectors and matrices; -1 otherwise
+    int LLVMGen::getArithmeticElementTypeId(std::shared_ptr<Type> type) {
+        if (type == nullptr) {
+            return -1;
+        }
+        int typeId = type->getTypeId();
+        if (typeId == Type::INTEGER || typeId == Type::INTEGER_1 || typeId == Type::INTEGER_2) {
+            return ELEMENT_INTEGER;
+        }
+        if (typeId == Type::REAL || typeId == Type::REAL_1 || typeId == Type::REAL_2) {
+            return ELEMENT_REAL;
+        }
+        return -1;
+    }
+
+    // An arithmetic operation on vectors or matrices whose operands all have its element type, i.e. one that
+    // getBinaryOperationEntryPoint sends to variableInitFromIntegerArrayBinOp or variableInitFromRealArrayBinOp
+    bool LLVMGen::isFusableArrayOperation(std::shared_ptr<AST> t, int elementTypeId) {
+        if (t->getNodeType() != GazpreaParser::BINARY_OP_TOKEN) {
+            return false;
+        }
+        switch (t->children[2]->getNodeType()) {
+            case GazpreaParser::CARET:
+            case GazpreaParser::ASTERISK:
+            case GazpreaParser::DIV:
+            case GazpreaParser::MODULO:
+            case GazpreaParser::PLUS:
+            case GazpreaParser::MINUS:
+                break;
+            default:
+                return false;
+        }
+        int typeId = t->evalType == nullptr ? -1 : t->evalType->getTypeId();
+        if (typeId != Type::INTEGER_1 && typeId != Type::INTEGER_2 && typeId != Type::REAL_1 && typeId != Type::REAL_2) {
+            return false;
+        }
+        return getArithmeticElementTypeId(t->evalType) == elementTypeId
+            && getArithmeticElementTypeId(t->children[0]->evalType) == elementTypeId
+            && getArithmeticElementTypeId(t->children[1]->evalType) == elementTypeId;
+    }
+
+    // The operands of a fused expression are all evaluated before any of its operations, so apart from the first one
+    // they must be atoms that can neither have side effects nor raise an error ahead of an operation that precedes them
+    bool LLVMGen::isFusableOperand(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::IDENTIFIER_TOKEN:
+            case GazpreaParser::TUPLE_ACCESS_TOKEN:
+            case GazpreaParser::IntegerConstant:
+            case GazpreaParser::REAL_CONSTANT_TOKEN:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Fusing pays off once an operation consumes the result of another, which would otherwise be a full size
+    // temporary array
+    bool LLVMGen::canFuseArrayExpression(std::shared_ptr<AST> t) {
+        if (optLevel == 0) {
+            return false;
+        }
+        int elementTypeId = getArithmeticElementTypeId(t->evalType);
+        if (!isFusableArrayOperation(t, elementTypeId)) {
+            return false;
+        }
+        if (!isFusableArrayOperation(t->children[0], elementTypeId) && !isFusableArrayOperation(t->children[1], elementTypeId)) {
+            return false;
+        }
+        std::vector<int32_t> program;
+        std::vector<std::shared_ptr<AST>> operands;
+        int stackDepth = 0;
+        int maxStackDepth = 0;
+        collectFusedProgram(t, elementTypeId, program, operands, stackDepth, maxStackDepth);
+        if (maxStackDepth > MAX_FUSED_STACK_DEPTH) {
+            return false;
+        }
+        for (size_t i = 1; i < operands.size(); i++) {
+            if (!isFusableOperand(operands[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Appends t in postfix order: operation i is encoded as its BinOpCode and the k-th operand as -1 - k
+    void LLVMGen::collectFusedProgram(std::shared_ptr<AST> t, int elementTypeId, std::vector<int32_t> &program,
+                                      std::vector<std::shared_ptr<AST>> &operands, int &stackDepth, int &maxStackDepth) {
+        if (!isFusableArrayOperation(t, elementTypeId)) {
+            program.push_back(-1 - (int32_t)operands.size());
+            operands.push_back(t);
+            maxStackDepth = std::max(maxStackDepth, ++stackDepth);
+            return;
+        }
+        collectFusedProgram(t->children[0], elementTypeId, program, operands, stackDepth, maxStackDepth);
+        collectFusedProgram(t->children[1], elementTypeId, program, operands, stackDepth, maxStackDepth);
+        program.push_back(getBinaryOpCode(t));
+        stackDepth--;
+    }
+
+    // Computes a tree of element-wise operations in one runtime call that evaluates it block by block, instead of
+    // one call per operation each filling a full size temporary array
+    void LLVMGen::visitFusedArrayExpression(std::shared_ptr<AST> t) {
+        int elementTypeId = getArithmeticElementTypeId(t->evalType);
+        std::vector<int32_t> program;
+        std::vector<std::shared_ptr<AST>> operands;
+        int stackDepth = 0;
+        int maxStackDepth = 0;
+        collectFusedProgram(t, elementTypeId, program, operands, stackDepth, maxStackDepth);
+
+        std::vector<llvm::Constant*> instructions;
+        for (auto instruction : program) {
+            instructions.push_back(ir.getInt32(instruction));
+        }
+        auto programTy = llvm::ArrayType::get(ir.getInt32Ty(), program.size());
+        auto *programGlobal = new llvm::GlobalVariable(mod, programTy, true, llvm::GlobalValue::PrivateLinkage,
+                                                       llvm::ConstantArray::get(programTy, instructions), "fusedProgram");
+        programGlobal->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+
+        llvm::BasicBlock& entryBB = ir.GetInsertBlock()->getParent()->getEntryBlock();
+        llvm::IRBuilder<llvm::NoFolder> entryBuilder(&entryBB, entryBB.begin());
+        auto operandArrayTy = llvm::ArrayType::get(runtimeVariableTy->getPointerTo(), operands.size());
+        auto operandArray = entryBuilder.CreateAlloca(operandArrayTy, nullptr, "fusedOperands");
+        for (size_t i = 0; i < operands.size(); i++) {
+            visit(operands[i]);
+            ir.CreateStore(operands[i]->llvmValue, ir.CreateConstInBoundsGEP2_32(operandArrayTy, operandArray, 0, i));
+        }
+
+        auto runtimeVariableObject = allocateTemporary(t);
+        llvmFunction.call("variableInitFromFusedArrayExpression", {
+            runtimeVariableObject,
+            ir.getInt32(elementTypeId),
+            ir.CreateConstInBoundsGEP2_32(programTy, programGlobal, 0, 0),
+            ir.getInt32(program.size()),
+            ir.CreateConstInBoundsGEP2_32(operandArrayTy, operandArray, 0, 0),
+            ir.getInt32(operands.size())
+        });
+        t->llvmValue = runtimeVariableObject;
+
+        for (auto &operand : operands) {
+            freeExprAtomIfNecessary(operand);
+        }
+    }
+
+    // Element-wise arithmetic and comparison between operands TypeWalk resolved to the same integer or real element
+    // type skip the runtime's promotion and dispatch; everything else goes through the generic variableInitFromBinaryOp
+    std::string LLVMGen::getBinaryOperationEntryPoint(std::shared_ptr<AST> t) {
+        switch (t->children[2]->getNodeType()) {
+            case GazpreaParser::CARET:
+            case GazpreaParser::ASTERISK:
+            case GazpreaParser::DIV:
+            case GazpreaParser::MODULO:
+            case GazpreaParser::PLUS:
+            case GazpreaParser::MINUS:
+            case GazpreaParser::LESSTHAN:
+            case GazpreaParser::GREATERTHAN:
+            case GazpreaParser::LESSTHANOREQUAL:
+            case GazpreaParser::GREATERTHANOREQUAL:
+                break;
+            default:
+                return "variableInitFromBinaryOp";
+        }
+        auto lhsType = t->children[0]->evalType;
+        auto rhsType = t->children[1]->evalType;
+        if (lhsType == nullptr || rhsType == nullptr) {
+            return "variableInitFromBinaryOp";
+        }
+        int lhsTypeId = lhsType->getTypeId();
+        int rhsTypeId = rhsType->getTypeId();
+        if ((lhsTypeId == Type::INTEGER || lhsTypeId == Type::INTEGER_1 || lhsTypeId == Type::INTEGER_2)
+            && (rhsTypeId == Type::INTEGER || rhsTypeId == Type::INTEGER_1 || rhsTypeId == Type::INTEGER_2)) {
+            return "variableInitFromIntegerArrayBinOp";
+        }
+        if ((lhsTypeId == Type::REAL || lhsTypeId == Type::REAL_1 || lhsTypeId == Type::REAL_2)
+            && (rhsTypeId == Type::REAL || rhsTypeId == Type::REAL_1 || rhsTypeId == Type::REAL_2)) {
+            return "variableInitFromRealArrayBinOp";
+        }
+        return "variableInitFromBinaryOp";
+    }
+
+    // Returns the type id of an expression that can be held in a native i1, i32 or float; -1 otherwise
+    int LLVMGen::getUnboxedScalarTypeId(std::shared_ptr<AST> t) {
+        if (t->evalType == nullptr) {
+            return -1;
+        }
+        int typeId = t->evalType->getTypeId();
+        if (typeId == Type::BOOLEAN || typeId == Type::INTEGER || typeId == Type::REAL) {
+            return typeId;
+        }
+        return -1;
+    }
+
+    // An operation is unboxed when TypeWalk proved both operands are scalars the runtime would compute element-wise.
+    // Character operands and identity/null are left to the runtime, which owns their promotion and error rules
+    bool LLVMGen::canUnboxOperation(std::shared_ptr<AST> t) {
+        if (getUnboxedScalarTypeId(t) == -1) {
+            return false;
+        }
+        if (t->getNodeType() == GazpreaParser::UNARY_TOKEN) {
+            auto operandTypeId = getUnboxedScalarTypeId(t->children[1]);
+            if (t->children[0]->getNodeType() == GazpreaParser::NOT) {
+                return operandTypeId == Type::BOOLEAN;
+            }
+            return operandTypeId == Type::INTEGER || operandTypeId == Type::REAL;
+        }
+        if (t->getNodeType() != GazpreaParser::BINARY_OP_TOKEN) {
+            return false;
+        }
+        auto lhsTypeId = getUnboxedScalarTypeId(t->children[0]);
+        auto rhsTypeId = getUnboxedScalarTypeId(t->children[1]);
+        if (lhsTypeId == -1 || rhsTypeId == -1) {
+            return false;
+        }
+        bool isNumeric = lhsTypeId != Type::BOOLEAN && rhsTypeId != Type::BOOLEAN;
+        switch (t->children[2]->getNodeType()) {
+            case GazpreaParser::AND:
+            case GazpreaParser::OR:
+            case GazpreaParser::XOR:
+                return lhsTypeId == Type::BOOLEAN && rhsTypeId == Type::BOOLEAN;
+            case GazpreaParser::ISEQUAL:
+            case GazpreaParser::ISNOTEQUAL:
+                return lhsTypeId == rhsTypeId || isNumeric;
+            case GazpreaParser::CARET:
+            case GazpreaParser::ASTERISK:
+            case GazpreaParser::DIV:
+            case GazpreaParser::MODULO:
+            case GazpreaParser::PLUS:
+            case GazpreaParser::MINUS:
+            case GazpreaParser::LESSTHAN:
+            case GazpreaParser::GREATERTHAN:
+            case GazpreaParser::LESSTHANOREQUAL:
+            case GazpreaParser::GREATERTHANOREQUAL:
+                return isNumeric;
+            default:
+                return false;
+        }
+    }
+
+    // Evaluates a scalar expression to a native value; anything that is not a literal or an unboxable operation
+    // is evaluated through the runtime and unboxed at the boundary
+    llvm::Value* LLVMGen::visitUnboxedScalar(std::shared_ptr<AST> t) {
+        switch (t->getNodeType()) {
+            case GazpreaParser::IntegerConstant:
+                return ir.getInt32(std::stoi(t->getText()));
+            case GazpreaParser::REAL_CONSTANT_TOKEN:
+                return llvm::ConstantFP::get(ir.getFloatTy(), std::stof(t->getText()));
+            case GazpreaParser::BooleanConstant:
+                return ir.getInt1(t->getText() == "true");
+            case GazpreaParser::BINARY_OP_TOKEN:
+                if (canUnboxOperation(t)) {
+                    return visitUnboxedBinaryOperation(t);
+                }
+                break;
+            case GazpreaParser::UNARY_TOKEN:
+                if (canUnboxOperation(t)) {
+                    return visitUnboxedUnaryOperation(t);
+                }
+                break;
+            case GazpreaParser::INDEXING_TOKEN:
+                if (canInlineIndexing(t)) {
+                    return visitInlinedIndexing(t);
+                }
+                break;
+        }
+        visit(t);
+        auto scalarValue = unboxScalar(t->llvmValue, getUnboxedScalarTypeId(t));
+        freeExprAtomIfNecessary(t);
+        return scalarValue;
+    }
+
+    llvm::Value* LLVMGen::visitUnboxedBinaryOperation(std::shared_ptr<AST> t) {
+        auto lhsTypeId = getUnboxedScalarTypeId(t->children[0]);
+        auto rhsTypeId = getUnboxedScalarTypeId(t->children[1]);
+        auto lhs = visitUnboxedScalar(t->children[0]);
+        auto rhs = visitUnboxedScalar(t->children[1]);
+        auto op = t->children[2]->getNodeType();
+
+        if (lhsTypeId == Type::BOOLEAN) {
+            switch (op) {
+                case GazpreaParser::AND:
+                    return ir.CreateAnd(lhs, rhs);
+                case GazpreaParser::OR:
+                    return ir.CreateOr(lhs, rhs);
+                case GazpreaParser::XOR:
+                    return ir.CreateXor(lhs, rhs);
+                case GazpreaParser::ISEQUAL:
+                    return ir.CreateICmpEQ(lhs, rhs);
+                default:
+                    return ir.CreateICmpNE(lhs, rhs);
+            }
+        }
+
+        if (lhsTypeId == Type::REAL || rhsTypeId == Type::REAL) {
+            // integer operand is promoted to real, same as the runtime
+            if (lhsTypeId == Type::INTEGER) {
+                lhs = ir.CreateSIToFP(lhs, ir.getFloatTy());
+            }
+            if (rhsTypeId == Type::INTEGER) {
+                rhs = ir.CreateSIToFP(rhs, ir.getFloatTy());
+            }
+            switch (op) {
+                case GazpreaParser::CARET:
+                    return ir.CreateBinaryIntrinsic(llvm::Intrinsic::pow, lhs, rhs);
+                case GazpreaParser::ASTERISK:
+                    return ir.CreateFMul(lhs, rhs);
+                case GazpreaParser::DIV:
+                    return ir.CreateFDiv(lhs, rhs);
+                case GazpreaParser::MODULO:
+                    return ir.CreateFRem(lhs, rhs);  // same as fmodf
+                case GazpreaParser::PLUS:
+                    return ir.CreateFAdd(lhs, rhs);
+                case GazpreaParser::MINUS:
+                    return ir.CreateFSub(lhs, rhs);
+                case GazpreaParser::LESSTHAN:
+                    return ir.CreateFCmpOLT(lhs, rhs);
+                case GazpreaParser::GREATERTHAN:
+                    return ir.CreateFCmpOGT(lhs, rhs);
+                case GazpreaParser::LESSTHANOREQUAL:
+                    return ir.CreateFCmpOLE(lhs, rhs);
+                case GazpreaParser::GREATERTHANOREQUAL:
+                    return ir.CreateFCmpOGE(lhs, rhs);
+                case GazpreaParser::ISEQUAL:
+                    return ir.CreateFCmpOEQ(lhs, rhs);
+                default:
+                    return ir.CreateFCmpUNE(lhs, rhs);
+            }
+        }
+
+        switch (op) {
+            case GazpreaParser::CARET:
+                return llvmFunction.call("integerExponentiation", {lhs, rhs});
+            case GazpreaParser::ASTERISK:
+                return ir.CreateMul(lhs, rhs);
+            case GazpreaParser::DIV:
+                createDivisionByZeroCheck(rhs, "Attempt to divide by zero!");
+                return ir.CreateSDiv(lhs, rhs);
+            case GazpreaParser::MODULO: {
+                // computed in 64 bits like the runtime so INT_MIN % -1 does not trap
+                createDivisionByZeroCheck(rhs, "Attempt to mod by zero!");
+                auto remainder = ir.CreateSRem(ir.CreateSExt(lhs, ir.getInt64Ty()), ir.CreateSExt(rhs, ir.getInt64Ty()));
+                return ir.CreateTrunc(remainder, ir.getInt32Ty());
+            }
+            case GazpreaParser::PLUS:
+                return ir.CreateAdd(lhs, rhs);
+            case GazpreaParser::MINUS:
+                return ir.CreateSub(lhs, rhs);
+            case GazpreaParser::LESSTHAN:
+                return ir.CreateICmpSLT(lhs, rhs);
+            case GazpreaParser::GREATERTHAN:
+                return ir.CreateICmpSGT(lhs, rhs);
+            case GazpreaParser::LESSTHANOREQUAL:
+                return ir.CreateICmpSLE(lhs, rhs);
+            case GazpreaParser::GREATERTHANOREQUAL:
+                return ir.CreateICmpSGE(lhs, rhs);
+            case GazpreaParser::ISEQUAL:
+                return ir.CreateICmpEQ(lhs, rhs);
+            default:
+                return ir.CreateICmpNE(lhs, rhs);
+        }
+    }
+
+    llvm::Value* LLVMGen::visitUnboxedUnaryOperation(std::shared_ptr<AST> t) {
+        auto op = t->children[0]->getNodeType();
+        auto operand = t->children[1];
+        if (op == GazpreaParser::MINUS
+        && operand->getNodeType() == GazpreaParser::IntegerConstant
+        && operand->getText() == "2147483648") {
+            // Handle the edge case: -2147483648
+            return ir.getInt32(-2147483648);
+        }
+        auto value = visitUnboxedScalar(operand);
+        switch (op) {
+            case GazpreaParser::PLUS:
+                return value;
+            case GazpreaParser::MINUS:
+                if (getUnboxedScalarTypeId(operand) == Type::REAL) {
+                    return ir.CreateFNeg(value);
+                }
+                return ir.CreateNeg(value);
+            default:
+                // "not" operator
+                return ir.CreateNot(value);
+        }
+    }
+
+    llvm::Value* LLVMGen::unboxScalar(llvm::Value* runtimeVariableObject, int typeId) {
+        switch (typeId) {
+            case Type::BOOLEAN:
+                return ir.CreateICmpNE(llvmFunction.call("variableGetBooleanValue", {runtimeVariableObject}), ir.getInt32(0));
+            case Type::INTEGER:
+                return llvmFunction.call("variableGetIntegerValue", {runtimeVariableObject});
+            default:
+                return llvmFunction.call("variableGetRealValue", {runtimeVariableObject});
+        }
+    }
+
+    llvm::Value* LLVMGen::boxScalar(llvm::Value* scalarValue, std::shared_ptr<AST> t) {
+        auto runtimeVariableObject = t == nullptr ? llvmFunction.call("variableMalloc", {}) : allocateTemporary(t);
+        auto scalarTy = scalarValue->getType();
+        if (scalarTy->isIntegerTy(1)) {
+            llvmFunction.call("variableInitFromBooleanScalar", {runtimeVariableObject, ir.CreateZExt(scalarValue, ir.getInt32Ty())});
+        } else if (scalarTy->isIntegerTy(32)) {
+            llvmFunction.call("variableInitFromIntegerScalar", {runtimeVariableObject, scalarValue});
+        } else {
+            llvmFunction.call("variableInitFromRealScalar", {runtimeVariableObject, scalarValue});
+        }
+        return runtimeVariableObject;
+    }
+
+    // Evaluates the boolean expression of a conditional or loop to an i1, without boxing when it is unboxable
+    llvm::Value* LLVMGen::createConditionValue(std::shared_ptr<AST> t) {
+        auto exprAST = t->children[0];
+        if (getUnboxedScalarTypeId(exprAST) == Type::BOOLEAN
+        && (canUnboxOperation(exprAST) || exprAST->getNodeType() == GazpreaParser::BooleanConstant)) {
+            numExprAncestors++;
+            auto condition = visitUnboxedScalar(exprAST);
+            numExprAncestors--;
+            return condition;
+        }
+        visit(t);
+        auto exprValue = llvmFunction.call("variableGetBooleanValue", {t->llvmValue});
+        freeExpressionIfNecessary(t);
+        return ir.CreateICmpNE(exprValue, ir.getInt32(0));
+    }
+
+    // A scalar read out of a named vector or matrix with scalar integer indices can be loaded straight from m_data
+    bool LLVMGen::canInlineIndexing(std::shared_ptr<AST> t) {
+        auto elementTypeId = getUnboxedScalarTypeId(t);
+        auto arrayAST = t->children[0];
+        if (elementTypeId == -1 || arrayAST->getNodeType() != GazpreaParser::IDENTIFIER_TOKEN || arrayAST->evalType == nullptr) {
+            return false;
+        }
+        size_t numIndices = t->children[1]->children.size();
+        switch (arrayAST->evalType->getTypeId()) {
+            case Type::BOOLEAN_1:
+                if (elementTypeId != Type::BOOLEAN || numIndices != 1) return false;
+                break;
+            case Type::INTEGER_1:
+                if (elementTypeId != Type::INTEGER || numIndices != 1) return false;
+                break;
+            case Type::REAL_1:
+                if (elementTypeId != Type::REAL || numIndices != 1) return false;
+                break;
+            case Type::BOOLEAN_2:
+                if (elementTypeId != Type::BOOLEAN || numIndices != 2) return false;
+                break;
+            case Type::INTEGER_2:
+                if (elementTypeId != Type::INTEGER || numIndices != 2) return false;
+                break;
+            case Type::REAL_2:
+                if (elementTypeId != Type::REAL || numIndices != 2) return false;
+                break;
+            default:
+                return false;
+        }
+        for (auto &indexExpr : t->children[1]->children) {
+            if (getUnboxedScalarTypeId(indexExpr->children[0]) != Type::INTEGER) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Emits a guarded GEP+load. The guard checks the variable really is a concrete (non-ref) array of the expected
+    // element type and that the indices are in range; otherwise the runtime indexing path runs and reports any error
+    llvm::Value* LLVMGen::visitInlinedIndexing(std::shared_ptr<AST> t) {
+        auto elementTypeId = getUnboxedScalarTypeId(t);
+        int runtimeElementTypeId;
+        llvm::Type *elementTy;
+        switch (elementTypeId) {
+            case Type::INTEGER:
+                runtimeElementTypeId = 0; // ELEMENT_INTEGER
+                elementTy = ir.getInt32Ty();
+                break;
+            case Type::REAL:
+                runtimeElementTypeId = 1; // ELEMENT_REAL
+                elementTy = ir.getFloatTy();
+                break;
+            default:
+                runtimeElementTypeId = 2; // ELEMENT_BOOLEAN
+                elementTy = ir.getInt32Ty(); // bool in runtime is int32_t
+                break;
+        }
+
+        visit(t->children[0]);
+        auto arrayVariable = t->children[0]->llvmValue;
+        std::vector<llvm::Value *> indices;
+        for (auto &indexExpr : t->children[1]->children) {
+            indices.push_back(visitUnboxedScalar(indexExpr->children[0]));
+        }
+
+        llvm::Function* parentFunc = ir.GetInsertBlock()->getParent();
+        llvm::BasicBlock* checkBoundsBB = llvm::BasicBlock::Create(globalCtx, "IndexCheckBounds", parentFunc);
+        llvm::BasicBlock* loadBB = llvm::BasicBlock::Create(globalCtx, "IndexLoad", parentFunc);
+        llvm::BasicBlock* runtimeBB = llvm::BasicBlock::Create(globalCtx, "IndexRuntime", parentFunc);
+        llvm::BasicBlock* mergeBB = llvm::BasicBlock::Create(globalCtx, "IndexMerge", parentFunc);
+
+        auto runtimeType = ir.CreateLoad(runtimeTypeTy->getPointerTo(), ir.CreateStructGEP(runtimeVariableTy, arrayVariable, 0));
+        auto typeId = ir.CreateLoad(ir.getInt32Ty(), ir.CreateStructGEP(runtimeTypeTy, runtimeType, 0));
+        auto arrayType = ir.CreatePointerCast(
+            ir.CreateLoad(ir.getInt8PtrTy(), ir.CreateStructGEP(runtimeTypeTy, runtimeType, 1)),
+            runtimeArrayTypeTy->getPointerTo());
+        // only dereference the compound type info once the type is known to be an ndarray
+        llvm::BasicBlock* checkArrayTypeBB = llvm::BasicBlock::Create(globalCtx, "IndexCheckArrayType", parentFunc, checkBoundsBB);
+        ir.CreateCondBr(ir.CreateICmpEQ(typeId, ir.getInt32(0)), checkArrayTypeBB, runtimeBB); // TYPEID_NDARRAY
+
+        ir.SetInsertPoint(checkArrayTypeBB);
+        auto elementTypeIdValue = ir.CreateLoad(ir.getInt32Ty(), ir.CreateStructGEP(runtimeArrayTypeTy, arrayType, 0));
+        auto nDim = ir.CreateLoad(ir.getInt8Ty(), ir.CreateStructGEP(runtimeArrayTypeTy, arrayType, 1));
+        auto isRef = ir.CreateLoad(ir.getInt32Ty(), ir.CreateStructGEP(runtimeArrayTypeTy, arrayType, 7));
+        auto isConcrete = ir.CreateAnd(
+            ir.CreateAnd(ir.CreateICmpEQ(elementTypeIdValue, ir.getInt32(runtimeElementTypeId)),
+                         ir.CreateICmpEQ(nDim, ir.getInt8(indices.size()))),
+            ir.CreateICmpEQ(isRef, ir.getInt32(0)));
+        ir.CreateCondBr(isConcrete, checkBoundsBB, runtimeBB);
+
+        // gazprea indices start at 1; an unsigned compare also rejects indices below 1
+        ir.SetInsertPoint(checkBoundsBB);
+        llvm::Value *inBounds = ir.getTrue();
+        llvm::Value *position = ir.getInt64(0);
+        for (size_t i = 0; i < indices.size(); i++) {
+            auto dimension = ir.CreateLoad(ir.getInt64Ty(), ir.CreateConstInBoundsGEP2_32(
+                runtimeArrayTypeTy->getElementType(2), ir.CreateStructGEP(runtimeArrayTypeTy, arrayType, 2), 0, i));
+            auto offset = ir.CreateSub(ir.CreateSExt(indices[i], ir.getInt64Ty()), ir.getInt64(1));
+            inBounds = ir.CreateAnd(inBounds, ir.CreateICmpULT(offset, dimension));
+            position = ir.CreateAdd(ir.CreateMul(position, dimension), offset);
+        }
+        ir.CreateCondBr(inBounds, loadBB, runtimeBB);
+
+        ir.SetInsertPoint(loadBB);
+        auto data = ir.CreatePointerCast(
+            ir.CreateLoad(ir.getInt8PtrTy(), ir.CreateStructGEP(runtimeVariableTy, arrayVariable, 1)),
+            elementTy->getPointerTo());
+        llvm::Value *loadedValue = ir.CreateLoad(elementTy, ir.CreateGEP(elementTy, data, position));
+        if (elementTypeId == Type::BOOLEAN) {
+            loadedValue = ir.CreateICmpNE(loadedValue, ir.getInt32(0));
+        }
+        ir.CreateBr(mergeBB);
+        loadBB = ir.GetInsertBlock();
+
+        ir.SetInsertPoint(runtimeBB);
+        std::vector<llvm::Value *> boxedIndices;
+        for (auto index : indices) {
+            boxedIndices.push_back(boxScalar(index));
+        }
+        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        if (indices.size() == 1) {
+            llvmFunction.call("variableInitFromVectorIndexing", {runtimeVariableObject, arrayVariable, boxedIndices[0]});
+        } else {
+            llvmFunction.call("variableInitFromMatrixIndexing", {runtimeVariableObject, arrayVariable, boxedIndices[0], boxedIndices[1]});
+        }
+        auto runtimeValue = unboxScalar(runtimeVariableObject, elementTypeId);
+        llvmFunction.call("variableDestructThenFree", {runtimeVariableObject});
+        for (auto boxedIndex : boxedIndices) {
+            llvmFunction.call("variableDestructThenFree", {boxedIndex});
+        }
+        ir.CreateBr(mergeBB);
+        runtimeBB = ir.GetInsertBlock();
+
+        ir.SetInsertPoint(mergeBB);
+        auto result = ir.CreatePHI(loadedValue->getType(), 2);
+        result->addIncoming(loadedValue, loadBB);
+        result->addIncoming(runtimeValue, runtimeBB);
+        return result;
+    }
+
+    void LLVMGen::createDivisionByZeroCheck(llvm::Value* divisor, const std::string& errorMsg) {
+        llvm::Function* parentFunc = ir.GetInsertBlock()->getParent();
+        llvm::BasicBlock* divideByZeroBB = llvm::BasicBlock::Create(globalCtx, "DivideByZero", parentFunc);
+        llvm::BasicBlock* divideBB = llvm::BasicBlock::Create(globalCtx, "Divide", parentFunc);
+        ir.CreateCondBr(ir.CreateICmpEQ(divisor, ir.getInt32(0)), divideByZeroBB, divideBB);
+        ir.SetInsertPoint(divideByZeroBB);
+        llvmFunction.call("errorAndExit", {ir.CreateGlobalStringPtr(errorMsg)});
+        ir.CreateUnreachable();
+        ir.SetInsertPoint(divideBB);
+    }
+
+    // An indexed argument bound to a var parameter is a reference the callee may write through
+    void LLVMGen::visitCallArguments(std::shared_ptr<AST> t) {
+        auto subroutineSymbol = std::dynamic_pointer_cast<SubroutineSymbol>(t->children[0]->symbol);
+        visit(t->children[0]);
+        auto &arguments = t->children[1]->children;
+        for (size_t i = 0; i < arguments.size(); i++) {
+            std::shared_ptr<VariableSymbol> parameterSymbol;
+            if (!subroutineSymbol->isBuiltIn && i < subroutineSymbol->orderedArgs.size()) {
+                parameterSymbol = std::dynamic_pointer_cast<VariableSymbol>(subroutineSymbol->orderedArgs[i]);
+            }
+            isIndexingWriteTarget = parameterSymbol != nullptr && parameterSymbol->typeQualifier == "var";
+            visit(arguments[i]);
+            isIndexingWriteTarget = false;
+        }
+    }
+
     void LLVMGen::visitCallSubroutineInExpression(std::shared_ptr<AST> t) {
-        visitChildren(t);
+        visitCallArguments(t);
         auto subroutineSymbol = std::dynamic_pointer_cast<SubroutineSymbol>(t->children[0]->symbol);
         auto *ctx = dynamic_cast<GazpreaParser::CallProcedureFunctionInExpressionContext*>(t->parseTree);
 
@@ -1832,7 +2506,7 @@ namespace gazprea
     }
 
     void LLVMGen::visitCallSubroutineStatement(std::shared_ptr<AST> t) {
-        visitChildren(t);
+        visitCallArguments(t);
         auto subroutineSymbol = std::dynamic_pointer_cast<SubroutineSymbol>(t->children[0]->symbol);
         auto *ctx = dynamic_cast<GazpreaParser::CallProcedureContext*>(t->parseTree);
         
@@ -1917,6 +2591,16 @@ namespace gazprea
 
     void LLVMGen::visitParameterAtom(std::shared_ptr<AST> t) {
         auto variableSymbol = std::dynamic_pointer_cast<VariableSymbol>(t->symbol);
+        if (variableSymbol->type == nullptr) {
+            // inferred type qualifier
+            variableSymbol->llvmPointerToTypeObject = getInternedRuntimeType(INTERNED_TYPE_UNKNOWN);
+            return;
+        }
+        auto internedTypeId = getInternedTypeId(variableSymbol->type->getTypeId());
+        if (internedTypeId != -1) {
+            variableSymbol->llvmPointerToTypeObject = getInternedRuntimeType(internedTypeId);
+            return;
+        }
         auto runtimeTypeObject = llvmFunction.call("typeMalloc", {}); 
         std::shared_ptr<MatrixType> matrixType;
         std::shared_ptr<TupleType> tupleType;
@@ -1925,12 +2609,6 @@ namespace gazprea
         llvm::Value *dimension1Expression = nullptr;
         llvm::Value *dimension2Expression = nullptr;
 
-        if (variableSymbol->type == nullptr) {
-            // inferred type qualifier
-            llvmFunction.call("typeInitFromUnknownType", { runtimeTypeObject });
-            variableSymbol->llvmPointerToTypeObject = runtimeTypeObject;
-            return;
-        }
         switch(variableSymbol->type->getTypeId()) {
             case Type::BOOLEAN:
                 llvmFunction.call("typeInitFromBooleanScalar", { runtimeTypeObject });
@@ -2002,10 +2680,8 @@ namespace gazprea
                 } else { 
                     dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromBooleanScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_BOOLEAN_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", {runtimeTypeObject, dimension1Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2024,10 +2700,8 @@ namespace gazprea
                 } else { 
                         dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromCharacterScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_CHARACTER_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", {runtimeTypeObject, dimension1Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2046,10 +2720,8 @@ namespace gazprea
                 } else { 
                         dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromIntegerScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_INTEGER_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", {runtimeTypeObject, dimension1Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2068,10 +2740,8 @@ namespace gazprea
                 } else { 
                         dimension1Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromRealScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_REAL_SCALAR);
                 llvmFunction.call("typeInitFromVectorSizeSpecification", {runtimeTypeObject, dimension1Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2094,10 +2764,8 @@ namespace gazprea
                 } else {
                         dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromBooleanScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_BOOLEAN_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", {runtimeTypeObject, dimension1Expression, dimension2Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2123,10 +2791,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromCharacterScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_CHARACTER_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", {runtimeTypeObject, dimension1Expression, dimension2Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2152,10 +2818,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromIntegerScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_INTEGER_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", {runtimeTypeObject, dimension1Expression, dimension2Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2181,10 +2845,8 @@ namespace gazprea
                 } else {
                     dimension2Expression = llvm::Constant::getNullValue(runtimeVariableTy->getPointerTo()); //vector size unknown at compile time
                 }
-                baseType = llvmFunction.call("typeMalloc", {});
-                llvmFunction.call("typeInitFromRealScalar", {baseType});
+                baseType = getInternedRuntimeType(INTERNED_TYPE_REAL_SCALAR);
                 llvmFunction.call("typeInitFromMatrixSizeSpecification", {runtimeTypeObject, dimension1Expression, dimension2Expression, baseType});
-                llvmFunction.call("typeDestructThenFree", baseType);
                 if (matrixType->def->children[1]->children[0]->getNodeType() == GazpreaParser::EXPRESSION_TOKEN) {
                     freeExpressionIfNecessary(matrixType->def->children[1]->children[0]);
                 }
@@ -2245,6 +2907,9 @@ namespace gazprea
     }
 
     void LLVMGen::visitVectorMatrixLiteral(std::shared_ptr<AST> t) {
+        if (visitConstantVectorLiteral(t)) {
+            return;
+        }
         visitChildren(t);
         auto numExpressions = t->children[0]->children.size();
         auto runtimeVariableArray = llvmFunction.call("variableArrayMalloc", { ir.getInt64(numExpressions) });
@@ -2263,6 +2928,126 @@ namespace gazprea
         }
     }
 
+    // A vector or matrix literal whose elements are all constants of one scalar type is emitted as constant data,
+    // without element variables or a mixed array. The runtime marks it as a literal, so like a mixed array it still
+    // promotes to the element type it is stored into. Returns false when the literal has to be built at runtime
+    bool LLVMGen::visitConstantVectorLiteral(std::shared_ptr<AST> t) {
+        auto &expressions = t->children[0]->children;
+        if (expressions.empty()) {
+            return false;
+        }
+        size_t nodeType = antlr4::Token::INVALID_TYPE;  // set by the first element
+        std::vector<std::vector<llvm::Constant*>> rows;
+        bool isMatrix = expressions[0]->children[0]->getNodeType() == GazpreaParser::VECTOR_LITERAL_TOKEN;
+        if (isMatrix) {
+            for (auto &expr : expressions) {
+                rows.emplace_back();
+                if (expr->children[0]->getNodeType() != GazpreaParser::VECTOR_LITERAL_TOKEN
+                    || !getConstantLiteralElements(expr->children[0], nodeType, rows.back())) {
+                    return false;
+                }
+            }
+        } else {
+            rows.emplace_back();
+            if (!getConstantLiteralElements(t, nodeType, rows.back())) {
+                return false;
+            }
+        }
+        int elementTypeId;
+        switch (nodeType) {
+            case GazpreaParser::IntegerConstant:
+                elementTypeId = ELEMENT_INTEGER;
+                break;
+            case GazpreaParser::REAL_CONSTANT_TOKEN:
+                elementTypeId = ELEMENT_REAL;
+                break;
+            case GazpreaParser::BooleanConstant:
+                elementTypeId = ELEMENT_BOOLEAN;
+                break;
+            default:
+                elementTypeId = ELEMENT_CHARACTER;
+                break;
+        }
+
+        // shorter rows of a matrix are padded with null, which is zero for every scalar type
+        size_t numColumns = 0;
+        for (auto &row : rows) {
+            numColumns = std::max(numColumns, row.size());
+        }
+        auto elementTy = rows[0][0]->getType();
+        std::vector<llvm::Constant*> elements;
+        for (auto &row : rows) {
+            elements.insert(elements.end(), row.begin(), row.end());
+            elements.insert(elements.end(), numColumns - row.size(), llvm::Constant::getNullValue(elementTy));
+        }
+        auto values = llvm::ConstantArray::get(llvm::ArrayType::get(elementTy, elements.size()), elements);
+        if (isMatrix) {
+            t->llvmValue = createConstantArrayVariable(values, false, elementTypeId, 2, rows.size(), numColumns);
+        } else {
+            t->llvmValue = createConstantArrayVariable(values, false, elementTypeId, 1, numColumns, 0);
+        }
+        return true;
+    }
+
+    // Appends the value of each element of a vector literal, all of which must be constants of the same kind
+    bool LLVMGen::getConstantLiteralElements(std::shared_ptr<AST> t, size_t &nodeType, std::vector<llvm::Constant*> &elements) {
+        auto &expressions = t->children[0]->children;
+        if (expressions.empty()) {
+            return false;
+        }
+        for (auto &expr : expressions) {
+            auto atom = expr->children[0];
+            if (nodeType == antlr4::Token::INVALID_TYPE) {
+                nodeType = atom->getNodeType();
+            } else if (atom->getNodeType() != nodeType) {
+                return false;
+            }
+            switch (nodeType) {
+                case GazpreaParser::IntegerConstant:
+                    elements.push_back(ir.getInt32(std::stoi(atom->getText())));
+                    break;
+                case GazpreaParser::REAL_CONSTANT_TOKEN:
+                    elements.push_back(llvm::ConstantFP::get(ir.getFloatTy(), std::stof(atom->getText())));
+                    break;
+                case GazpreaParser::BooleanConstant:
+                    elements.push_back(ir.getInt32(atom->getText() == "true"));
+                    break;
+                case GazpreaParser::CharacterConstant:
+                    elements.push_back(ir.getInt8(getCharacterAtomValue(atom)));
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // The literal's data and reference counters are private globals. The counters start with one permanent owner,
+    // so every variable created from them is a shared view that copies the data before its first write
+    llvm::Value* LLVMGen::createConstantArrayVariable(llvm::Constant *values, bool isString, int elementTypeId, int nDim,
+                                                      int64_t dim1, int64_t dim2) {
+        auto *data = new llvm::GlobalVariable(mod, values->getType(), true, llvm::GlobalValue::PrivateLinkage,
+                                              values, "arrayLiteral");
+        data->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+        auto refCountTy = llvm::ArrayType::get(ir.getInt32Ty(), 2);
+        auto *refCount = new llvm::GlobalVariable(mod, refCountTy, false, llvm::GlobalValue::PrivateLinkage,
+                                                  llvm::ConstantArray::get(refCountTy, {ir.getInt32(1), ir.getInt32(1)}),
+                                                  "arrayLiteralRefCount");
+
+        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        llvmFunction.call("variableInitFromConstantArray", {
+            runtimeVariableObject,
+            ir.getInt32(isString),
+            ir.getInt32(elementTypeId),
+            ir.getInt8(nDim),
+            ir.getInt64(dim1),
+            ir.getInt64(dim2),
+            ir.CreatePointerCast(data, ir.getInt8PtrTy()),
+            ir.CreatePointerCast(refCount, ir.getInt32Ty()->getPointerTo())
+        });
+        return runtimeVariableObject;
+    }
+
     void LLVMGen::visitTupleAccess(std::shared_ptr<AST> t) {
         visit(t->children[0]);
         if (t->children[1]->getNodeType() == GazpreaParser::IDENTIFIER_TOKEN) {
@@ -2343,7 +3128,11 @@ namespace gazprea
         for (auto const& [key, val] : scope->symbols) {
             auto vs = std::dynamic_pointer_cast<VariableSymbol>(val);
             if (vs != nullptr && vs->llvmPointerToVariableObject != nullptr) {
-                llvmFunction.call("variableDestructThenFree", vs->llvmPointerToVariableObject);
+                if (vs->isStackAllocated) {
+                    llvmFunction.call("variableDestructor", vs->llvmPointerToVariableObject);
+                } else {
+                    llvmFunction.call("variableDestructThenFree", vs->llvmPointerToVariableObject);
+                }
             }
         }
     }
@@ -2399,15 +3188,51 @@ namespace gazprea
     }
 
     void LLVMGen::freeExpressionIfNecessary(std::shared_ptr<AST> t) {
-        if (t->children[0]->getNodeType() != GazpreaParser::IDENTIFIER_TOKEN
-        && t->children[0]->getNodeType() != GazpreaParser::TUPLE_ACCESS_TOKEN) {
-            llvmFunction.call("variableDestructThenFree", t->llvmValue);
+        if (isTemporaryExpression(t)) {
+            freeTemporary(t->children[0]);
         }
     }
 
+    // The value of an expression is a temporary owned by the code using it, unless it is a variable or tuple field.
+    // A temporary can be handed to the runtime's *Move functions, which free it in place of freeExpressionIfNecessary
+    bool LLVMGen::isTemporaryExpression(std::shared_ptr<AST> t) {
+        return t->children[0]->getNodeType() != GazpreaParser::IDENTIFIER_TOKEN
+            && t->children[0]->getNodeType() != GazpreaParser::TUPLE_ACCESS_TOKEN;
+    }
+
+    // A variable the caller owns holding the value of expression t, which must not be freed afterwards
+    llvm::Value* LLVMGen::takeExpressionValue(std::shared_ptr<AST> t) {
+        auto runtimeVariableObject = llvmFunction.call("variableMalloc", {});
+        if (isTemporaryExpression(t)) {
+            llvmFunction.call("variableInitFromMove", {runtimeVariableObject, t->llvmValue});
+        } else {
+            llvmFunction.call("variableInitFromMemcpy", {runtimeVariableObject, t->llvmValue});
+        }
+        return runtimeVariableObject;
+    }
+
     void LLVMGen::freeExprAtomIfNecessary(std::shared_ptr<AST> t) {
         if (t->getNodeType() != GazpreaParser::IDENTIFIER_TOKEN
         && t->getNodeType() != GazpreaParser::TUPLE_ACCESS_TOKEN) {
+            freeTemporary(t);
+        }
+    }
+
+    // The result Variable of operation t, in the stack frame if EscapeWalk found that t does not escape its consumer
+    llvm::Value* LLVMGen::allocateTemporary(std::shared_ptr<AST> t) {
+        if (!t->isStackTemporary) {
+            return llvmFunction.call("variableMalloc", {});
+        }
+        auto runtimeVariableObject = createEntryBlockVariableAlloca("tmp");
+        ir.CreateLifetimeStart(runtimeVariableObject);
+        return runtimeVariableObject;
+    }
+
+    void LLVMGen::freeTemporary(std::shared_ptr<AST> t) {
+        if (t->isStackTemporary) {
+            llvmFunction.call("variableDestructor", t->llvmValue);
+            ir.CreateLifetimeEnd(t->llvmValue);
+        } else {
             llvmFunction.call("variableDestructThenFree", t->llvmValue);
         }
     }
@@ -2454,18 +3279,175 @@ namespace gazprea
         return res;
     }
 
-    void LLVMGen::Print() {
-        // write module as .ll file
-        std::string compiledLLFile;
-        llvm::raw_string_ostream out(compiledLLFile);
+    void LLVMGen::optimize() {
+        if (optLevel == 0) {
+            return;
+        }
+        llvm::LoopAnalysisManager loopAM;
+        llvm::FunctionAnalysisManager functionAM;
+        llvm::CGSCCAnalysisManager cgsccAM;
+        llvm::ModuleAnalysisManager moduleAM;
+
+        llvm::PassBuilder passBuilder(targetMachine.get());
+        passBuilder.registerModuleAnalyses(moduleAM);
+        passBuilder.registerCGSCCAnalyses(cgsccAM);
+        passBuilder.registerFunctionAnalyses(functionAM);
+        passBuilder.registerLoopAnalyses(loopAM);
+        passBuilder.crossRegisterProxies(loopAM, functionAM, cgsccAM, moduleAM);
+
+        llvm::OptimizationLevel level = llvm::OptimizationLevel::O1;
+        if (optLevel == 2) {
+            level = llvm::OptimizationLevel::O2;
+        } else if (optLevel >= 3) {
+            level = llvm::OptimizationLevel::O3;
+        }
+        llvm::ModulePassManager modulePM = passBuilder.buildPerModuleDefaultPipeline(level);
+        modulePM.run(mod, moduleAM);
+    }
 
-        llvm::raw_os_ostream llOut(std::cout);
+    void LLVMGen::initializeTargetMachine() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        auto targetTriple = llvm::sys::getDefaultTargetTriple();
+        std::string error;
+        auto target = llvm::TargetRegistry::lookupTarget(targetTriple, error);
+        if (target == nullptr) {
+            std::cerr << "Warning! No native target available: " << error << "\n";
+            return;
+        }
+        targetMachine.reset(target->createTargetMachine(
+            targetTriple, llvm::sys::getHostCPUName(), "", llvm::TargetOptions(), llvm::Reloc::PIC_));
+        mod.setTargetTriple(targetTriple);
+        mod.setDataLayout(targetMachine->createDataLayout());
+    }
+
+    bool LLVMGen::emitObjectFile(const std::string& filename) {
+        if (targetMachine == nullptr) {
+            std::cerr << "Error! Cannot emit an object file without a native target!\n";
+            return false;
+        }
+        std::error_code errorCode;
+        llvm::raw_fd_ostream dest(filename, errorCode, llvm::sys::fs::OF_None);
+        if (errorCode) {
+            std::cerr << "Error! Could not open " << filename << ": " << errorCode.message() << "\n";
+            return false;
+        }
+        llvm::legacy::PassManager codegenPM;
+        if (targetMachine->addPassesToEmitFile(codegenPM, dest, nullptr, llvm::CGFT_ObjectFile)) {
+            std::cerr << "Error! The native target cannot emit an object file!\n";
+            return false;
+        }
+        codegenPM.run(mod);
+        dest.flush();
+        return true;
+    }
+
+    bool LLVMGen::linkExecutable(const std::string& objectFile) {
+        auto linker = llvm::sys::findProgramByName("cc");
+        if (!linker) {
+            std::cerr << "Error! Could not find cc to link " << outfile << "\n";
+            return false;
+        }
+        llvm::StringRef args[] = { *linker, objectFile, runtimeLibrary, "-lm", "-pthread", "-o", outfile };
+        std::string errorMsg;
+        if (llvm::sys::ExecuteAndWait(*linker, args, llvm::None, {}, 0, 0, &errorMsg) != 0) {
+            std::cerr << "Error! Linking " << outfile << " failed: " << errorMsg << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Compiles the module with ORC LLJIT and calls main in this process, with gazrt loaded from sharedRuntimeLibrary
+    int LLVMGen::runMain(const std::string& sharedRuntimeLibrary) {
+        llvm::raw_os_ostream llErr(std::cerr);
+        if (llvm::verifyModule(mod, &llErr)) {
+            return 1;
+        }
+        optimize();
+
+        // LLJIT must own the module and its context, but both are members of LLVMGen;
+        // hand it a copy through an in-memory bitcode buffer
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream bitcodeStream(bitcode);
+        llvm::WriteBitcodeToFile(mod, bitcodeStream);
+        auto jitCtx = std::make_unique<llvm::LLVMContext>();
+        auto jitModule = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), mod.getModuleIdentifier()), *jitCtx);
+        if (!jitModule) {
+            std::cerr << "Error! " << llvm::toString(jitModule.takeError()) << "\n";
+            return 1;
+        }
+
+        auto jit = llvm::orc::LLJITBuilder().create();
+        if (!jit) {
+            std::cerr << "Error! " << llvm::toString(jit.takeError()) << "\n";
+            return 1;
+        }
+        auto globalPrefix = (*jit)->getDataLayout().getGlobalPrefix();
+        auto runtimeSymbols = llvm::orc::DynamicLibrarySearchGenerator::Load(sharedRuntimeLibrary.c_str(), globalPrefix);
+        if (!runtimeSymbols) {
+            std::cerr << "Error! Could not load the runtime " << sharedRuntimeLibrary << ": "
+                      << llvm::toString(runtimeSymbols.takeError()) << "\n";
+            return 1;
+        }
+        (*jit)->getMainJITDylib().addGenerator(std::move(*runtimeSymbols));
+        // libc and libm symbols used by the module itself e.g. powf
+        (*jit)->getMainJITDylib().addGenerator(
+            llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(globalPrefix)));
+
+        if (auto error = (*jit)->addIRModule(llvm::orc::ThreadSafeModule(std::move(*jitModule), std::move(jitCtx)))) {
+            std::cerr << "Error! " << llvm::toString(std::move(error)) << "\n";
+            return 1;
+        }
+        auto mainSymbol = (*jit)->lookup("main");
+        if (!mainSymbol) {
+            std::cerr << "Error! " << llvm::toString(mainSymbol.takeError()) << "\n";
+            return 1;
+        }
+        auto mainFunction = reinterpret_cast<int (*)()>(mainSymbol->getAddress());
+        return mainFunction();
+    }
+
+    // Writes the module to outfile in the requested format, returns false if nothing usable was written
+    bool LLVMGen::Print() {
         llvm::raw_os_ostream llErr(std::cerr);
-        llvm::verifyModule(mod, &llErr);
+        bool isModuleValid = !llvm::verifyModule(mod, &llErr);
+        if (isModuleValid) {
+            // only optimize and compile a well-formed module, a broken one is printed as is for debugging
+            optimize();
+            if (!runtimeLibrary.empty()) {
+                auto objectFile = outfile + ".o";
+                bool isLinked = emitObjectFile(objectFile) && linkExecutable(objectFile);
+                llvm::sys::fs::remove(objectFile);
+                return isLinked;
+            }
+            if (emitKind == EmitKind::OBJ) {
+                return emitObjectFile(outfile);
+            }
+        }
 
-        mod.print(out, nullptr);
-        out.flush();
-        std::ofstream outFile(outfile);
-        outFile << compiledLLFile;
+        // a broken module can only be printed as text; rather than passing that off as the bitcode, object file or
+        // executable that was asked for, it goes to <outfile>.ll and the compilation fails
+        bool isTextRequested = emitKind == EmitKind::LL && runtimeLibrary.empty();
+        std::string filename = isModuleValid || isTextRequested ? outfile : outfile + ".ll";
+
+        // stream the module straight to the output file as bitcode or as a .ll file
+        bool isBitcode = isModuleValid && emitKind == EmitKind::BC;
+        std::error_code errorCode;
+        llvm::raw_fd_ostream outFile(filename, errorCode, isBitcode ? llvm::sys::fs::OF_None : llvm::sys::fs::OF_Text);
+        if (errorCode) {
+            std::cerr << "Error! Could not open " << filename << ": " << errorCode.message() << "\n";
+            return false;
+        }
+        if (isBitcode) {
+            llvm::WriteBitcodeToFile(mod, outFile);
+        } else {
+            mod.print(outFile, nullptr);
+        }
+        if (!isModuleValid && !isTextRequested) {
+            std::cerr << "Error! The module is invalid, it was written to " << filename << " instead of " << outfile << "\n";
+            return false;
+        }
+        return true;
     }
 } // namespace gazprea
\ No newline at end of file
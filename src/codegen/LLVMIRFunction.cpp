@@ -38,6 +38,10 @@ void LLVMIRFunction::declareAllFunctions() {
         llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), int8Ty}, false),
         "variableInitFromCharacterScalar"
     );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), int32Ty, int32Ty}, false),
+        "variableInitFromIntegerInterval"
+    );
     declareFunction(
         llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), int64Ty, int8Ty->getPointerTo() }, false),
         "variableInitFromString"
@@ -84,6 +88,18 @@ void LLVMIRFunction::declareAllFunctions() {
         llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo(), int32Ty}, false),
         "variableInitFromBinaryOp"
     );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo(), int32Ty}, false),
+        "variableInitFromIntegerArrayBinOp"
+    );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), int32Ty, int32Ty->getPointerTo(), int32Ty, runtimeVariableTy->getPointerTo()->getPointerTo(), int32Ty}, false),
+        "variableInitFromFusedArrayExpression"
+    );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, {runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo(), int32Ty}, false),
+        "variableInitFromRealArrayBinOp"
+    );
 
     // Other
     declareFunction(
@@ -102,11 +118,21 @@ void LLVMIRFunction::declareAllFunctions() {
         "variableInitFromDeclaration"
     );
 
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), runtimeTypeTy->getPointerTo(), runtimeVariableTy->getPointerTo() }, false),
+        "variableInitFromDeclarationMove"
+    );
+
     declareFunction(
         llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo() }, false),
         "variableAssignment"
     );
 
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo() }, false),
+        "variableAssignMove"
+    );
+
     declareFunction(
             llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo() }, false),
             "variableReplace"
@@ -121,6 +147,20 @@ void LLVMIRFunction::declareAllFunctions() {
         llvm::FunctionType::get(int32Ty, { runtimeVariableTy->getPointerTo() }, false),
         "variableGetBooleanValue"
     );
+    declareFunction(
+        llvm::FunctionType::get(floatTy, { runtimeVariableTy->getPointerTo() }, false),
+        "variableGetRealValue"
+    );
+
+    // Unboxed scalar operations
+    declareFunction(
+        llvm::FunctionType::get(int32Ty, { int32Ty, int32Ty }, false),
+        "integerExponentiation"
+    );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { int8Ty->getPointerTo() }, false),
+        "errorAndExit"
+    );
 
     // TypeInit
     declareFunction(
@@ -168,16 +208,29 @@ void LLVMIRFunction::declareAllFunctions() {
         "variableInitFromParameter"
     );
 
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo() }, false),
+        "variableNDArrayMakeUnique"
+    );
+
     // Copy Variable
     declareFunction(
         llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo() }, false),
         "variableInitFromMemcpy"
     );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), runtimeVariableTy->getPointerTo() }, false),
+        "variableInitFromMove"
+    );
     // Free
     declareFunction(
         llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo() }, false),
         "variableDestructThenFree"
     );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo() }, false),
+        "variableDestructor"
+    );
     declareFunction(
         llvm::FunctionType::get(voidTy, { runtimeTypeTy->getPointerTo() }, false),
         "typeDestructThenFree"
@@ -250,6 +303,11 @@ void LLVMIRFunction::declareAllFunctions() {
         llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), int64Ty, runtimeVariableTy->getPointerTo()->getPointerTo() }, false),
         "variableInitFromVectorLiteral"
     );
+    declareFunction(
+        llvm::FunctionType::get(voidTy, { runtimeVariableTy->getPointerTo(), int32Ty, int32Ty, int8Ty, int64Ty, int64Ty,
+                                          int8Ty->getPointerTo(), int32Ty->getPointerTo() }, false),
+        "variableInitFromConstantArray"
+    );
     
     declareFunction(
         llvm::FunctionType::get(runtimeTypeTy->getPointerTo(), { runtimeVariableTy->getPointerTo(), runtimeTypeTy->getPointerTo() }, false),
@@ -10,11 +10,16 @@
 #include "DefWalk.h"
 #include "RefWalk.h"
 #include "TypeWalk.h"
+#include "InlineWalk.h"
+#include "ConstFoldWalk.h"
+#include "EscapeWalk.h"
 #include "LLVMGen.h"
 #include "TypePromote.h"
 #include "DiagnosticErrorListener.h"
 #include "BailErrorStrategy.h"
 #include "exceptions.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include <iostream>
 #include <fstream>
 
@@ -28,15 +33,56 @@ class MyErrorListener : public antlr4::BaseErrorListener {
 };
 
 int main(int argc, char **argv) {
-  if (argc < 3) {
+  // Flags can appear anywhere, the remaining arguments are the input and output file paths
+  unsigned optLevel = 0;
+  auto emitKind = gazprea::LLVMGen::EmitKind::LL;
+  std::string runtimeLibrary;
+  bool runInProcess = false;
+  std::string sharedRuntimeLibrary;
+  std::vector<std::string> fileArgs;
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' && arg[2] <= '3') {
+      optLevel = arg[2] - '0';
+    } else if (arg.rfind("-O", 0) == 0) {
+      std::cout << "Unknown optimization level: " << arg << "\n"
+                << "Optional arguments: -O<0|1|2|3>\n";
+      return 1;
+    } else if (arg == "-c" || arg == "--emit=obj") {
+      emitKind = gazprea::LLVMGen::EmitKind::OBJ;
+    } else if (arg == "--emit=bc") {
+      emitKind = gazprea::LLVMGen::EmitKind::BC;
+    } else if (arg == "--emit=ll") {
+      emitKind = gazprea::LLVMGen::EmitKind::LL;
+    } else if (arg.rfind("--emit=", 0) == 0) {
+      std::cout << "Unknown output format: " << arg.substr(7) << "\n";
+      return 1;
+    } else if (arg.rfind("--link=", 0) == 0) {
+      runtimeLibrary = arg.substr(7);
+    } else if (arg == "--run") {
+      runInProcess = true;
+    } else if (arg.rfind("--runtime=", 0) == 0) {
+      sharedRuntimeLibrary = arg.substr(10);
+    } else {
+      fileArgs.push_back(arg);
+    }
+  }
+  if (fileArgs.size() < (runInProcess ? 1 : 2)) {
     std::cout << "Missing required argument.\n"
-              << "Required arguments: <input file path> <output file path>\n";
+              << "Required arguments: <input file path> <output file path>\n"
+              << "                    <input file path> with --run\n"
+              << "Optional arguments: -O<0|1|2|3>\n"
+              << "                    --emit=<ll|bc|obj>      output format, defaults to ll\n"
+              << "                    -c                      same as --emit=obj\n"
+              << "                    --link=<libgazrt.a>     emit a native executable linked with the static runtime\n"
+              << "                    --run                   JIT compile and run main in process, no output file\n"
+              << "                    --runtime=<libgazrt.so> runtime loaded by --run, defaults to the one next to gazc\n";
     return 1;
   }
 
   // Open the file then parse and lex it.
   antlr4::ANTLRFileStream afs;
-  afs.loadFromFile(argv[1]);
+  afs.loadFromFile(fileArgs[0]);
   gazprea::GazpreaLexer lexer(&afs);
   antlr4::CommonTokenStream tokens(&lexer);
   gazprea::GazpreaParser parser(&tokens);
@@ -54,7 +100,7 @@ int main(int argc, char **argv) {
   auto ast = std::any_cast<std::shared_ptr<gazprea::AST>>(builder.visit(tree));
 
   // Initialize the symbol table
-  std::string outfile(argv[2]);
+  std::string outfile(runInProcess ? "" : fileArgs[1]);
   auto symtab = std::make_shared<gazprea::SymbolTable>();
 
   gazprea::DefWalk defwalk(symtab);
@@ -71,8 +117,31 @@ int main(int argc, char **argv) {
   gazprea::TypeWalk typewalk(symtab, tp);
   typewalk.visit(ast);
 
-  gazprea::LLVMGen llvmgen(symtab, tp, outfile);
+  if (optLevel > 0) {
+    gazprea::InlineWalk inlinewalk(symtab);
+    inlinewalk.visit(ast);
+
+    gazprea::ConstFoldWalk constfoldwalk(symtab);
+    constfoldwalk.visit(ast);
+
+    gazprea::EscapeWalk escapewalk;
+    escapewalk.visit(ast);
+  }
+
+  gazprea::LLVMGen llvmgen(symtab, tp, outfile, optLevel);
+  llvmgen.emitKind = emitKind;
+  llvmgen.runtimeLibrary = runtimeLibrary;
   llvmgen.visit(ast);
 
-  return 0;
+  if (runInProcess) {
+    if (sharedRuntimeLibrary.empty()) {
+      // bin/ holds both gazc and libgazrt.so; argv[0] has no directory when gazc was found through PATH
+      auto gazcPath = llvm::sys::fs::getMainExecutable(argv[0], (void *)&main);
+      auto gazcDir = llvm::sys::path::parent_path(gazcPath);
+      sharedRuntimeLibrary = (gazcDir.empty() ? std::string(".") : gazcDir.str()) + "/libgazrt.so";
+    }
+    return llvmgen.runMain(sharedRuntimeLibrary);
+  }
+
+  return llvmgen.Print() ? 0 : 1;
 }
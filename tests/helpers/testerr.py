@@ -51,6 +51,8 @@ def main():
     test_in_paths = getAllTestsInDirectory(test_prefix)
     
     selected_tests = [arg[:-5] for arg in sys.argv if arg.endswith(".test")]
+    # -O<n> is passed on to gazc
+    opt_flags = [arg for arg in sys.argv[1:] if len(arg) == 3 and arg[:2] == "-O" and arg[2] in "0123"]
 
     summary_stats = [0, 0]
     failed_files = []
@@ -75,6 +77,12 @@ def main():
         if len(results) != 3:
             raise RuntimeError("ERROR: Invalid number of #split_token found in file " + test_path)
 
+        # a program whose first line is "// gazc: <flags>" is compiled with those flags, unless -O<n> is given
+        test_flags = opt_flags
+        first_line = results[0].split("\n", 1)[0]
+        if len(test_flags) == 0 and first_line.startswith("// gazc: "):
+            test_flags = first_line[len("// gazc: "):].split()
+
         # write the input to a file so gazc can compile it
         with open("../gazprea_program.in", "w") as test_in:
             test_in.write(results[0])
@@ -102,7 +110,7 @@ def main():
         try:
             # to .ll
             llFile = "../gazprea_program.ll"
-            args = [root_path + "bin/gazc", "../gazprea_program.in", llFile]
+            args = [root_path + "bin/gazc"] + test_flags + ["../gazprea_program.in", llFile]
             run_program(args)
 
             error_state = 1